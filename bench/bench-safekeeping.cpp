@@ -0,0 +1,450 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "safekeeping/SafeKeeping.h"
+
+namespace fs = std::filesystem;
+using jgaa::safekeeping::SafeKeeping;
+
+namespace {
+
+// Points the library at a private data directory and a file-backed fake vault
+// so the benchmarks never touch the user's real namespaces or keyring.
+class BenchEnvironment {
+public:
+    BenchEnvironment() {
+        root_ = fs::temp_directory_path() /
+            ("safekeeping-bench_" + std::to_string(::getpid()) + "_" + std::to_string(std::rand()));
+        fs::create_directories(root_);
+        setenv("SAFEKEEPING_DATA_DIR", root_.string().c_str(), 1);
+        setenv("SAFEKEEPING_TEST_FAKE_VAULT_DIR", (root_ / "fake-vault").string().c_str(), 1);
+        unsetenv("SAFEKEEPING_DISABLE_SYSTEM_VAULT");
+    }
+
+    ~BenchEnvironment() {
+        std::error_code ignored;
+        fs::remove_all(root_, ignored);
+    }
+
+    BenchEnvironment(const BenchEnvironment&) = delete;
+    BenchEnvironment& operator=(const BenchEnvironment&) = delete;
+
+private:
+    fs::path root_;
+};
+
+BenchEnvironment& environment() {
+    static BenchEnvironment env;
+    return env;
+}
+
+SafeKeeping::ptr_t createVaultNamespace(const std::string& name) {
+    environment();
+    SafeKeeping::removeNamespace(name);
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = true;
+    return SafeKeeping::createNew(name, options).instance;
+}
+
+std::string secretName(int index) {
+    return "secret_" + std::to_string(index);
+}
+
+// Secret values are capped at 10,240 bytes by the library.
+constexpr std::int64_t kMaxValueSize = 10240;
+
+void valueSizes(benchmark::internal::Benchmark* bench) {
+    for (const std::int64_t size : {16, 256, 4096, static_cast<int>(kMaxValueSize)}) {
+        bench->Arg(size);
+    }
+}
+
+// A namespace with all three unlock slots, created once per name.
+struct SlottedNamespace {
+    std::string name;
+    std::string passphrase = "bench passphrase";
+    std::string recoveryKey;
+};
+
+const SlottedNamespace& slottedNamespace() {
+    static const SlottedNamespace ns = [] {
+        environment();
+        SlottedNamespace result;
+        result.name = "bench_unlock";
+        SafeKeeping::removeNamespace(result.name);
+        SafeKeeping::CreateOptions options;
+        options.passphrase = result.passphrase;
+        options.createRecoveryKey = true;
+        auto created = SafeKeeping::createNew(result.name, options);
+        result.recoveryKey = created.recoveryKey.value_or("");
+        return result;
+    }();
+    return ns;
+}
+
+SafeKeeping::ptr_t openLocked(const std::string& name) {
+    SafeKeeping::UnlockOptions options;
+    options.trySystemVaultFirst = false;
+    return SafeKeeping::open(name, options);
+}
+
+void BM_RetrieveSecret(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    auto sk = createVaultNamespace("bench_retrieve");
+    for (int i = 0; i < count; ++i) {
+        sk->storeSecret(secretName(i), std::string(64, 'x'));
+    }
+
+    int next = 0;
+    for (auto _ : state) {
+        auto value = sk->retrieveSecret(secretName(next));
+        benchmark::DoNotOptimize(value);
+        next = (next + 1) % count;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RetrieveSecret)->Arg(1)->Arg(100);
+
+// As BM_RetrieveSecret, through a second instance opened read-only.
+void BM_RetrieveSecretReadOnly(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    auto writer = createVaultNamespace("bench_retrieve_read_only");
+    for (int i = 0; i < count; ++i) {
+        writer->storeSecret(secretName(i), std::string(64, 'x'));
+    }
+    SafeKeeping::UnlockOptions options;
+    options.open.readOnly = true;
+    auto sk = SafeKeeping::open("bench_retrieve_read_only", options);
+
+    int next = 0;
+    for (auto _ : state) {
+        auto value = sk->retrieveSecret(secretName(next));
+        benchmark::DoNotOptimize(value);
+        next = (next + 1) % count;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RetrieveSecretReadOnly)->Arg(1)->Arg(100);
+
+// Arguments: value size in bytes.
+void BM_StoreSecretBySize(benchmark::State& state) {
+    auto sk = createVaultNamespace("bench_store_size");
+    const std::string value(static_cast<std::size_t>(state.range(0)), 'x');
+    int next = 0;
+    for (auto _ : state) {
+        sk->storeSecret(secretName(next), value);
+        next = (next + 1) % 100;
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StoreSecretBySize)->Apply(valueSizes)->Unit(benchmark::kMicrosecond);
+
+// Arguments: value size in bytes.
+void BM_RetrieveSecretBySize(benchmark::State& state) {
+    auto sk = createVaultNamespace("bench_retrieve_size");
+    const std::string value(static_cast<std::size_t>(state.range(0)), 'x');
+    for (int i = 0; i < 100; ++i) {
+        sk->storeSecret(secretName(i), value);
+    }
+    int next = 0;
+    for (auto _ : state) {
+        auto result = sk->retrieveSecret(secretName(next));
+        benchmark::DoNotOptimize(result);
+        next = (next + 1) % 100;
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RetrieveSecretBySize)->Apply(valueSizes);
+
+// Arguments: value size in bytes.
+void BM_RetrieveSecretIntoBySize(benchmark::State& state) {
+    auto sk = createVaultNamespace("bench_retrieve_into");
+    const std::string value(static_cast<std::size_t>(state.range(0)), 'x');
+    for (int i = 0; i < 100; ++i) {
+        sk->storeSecret(secretName(i), value);
+    }
+    std::vector<std::byte> buffer(value.size());
+    int next = 0;
+    for (auto _ : state) {
+        auto result = sk->retrieveSecretInto(secretName(next), buffer);
+        benchmark::DoNotOptimize(result);
+        next = (next + 1) % 100;
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RetrieveSecretIntoBySize)->Apply(valueSizes);
+
+// Arguments: value size in bytes. Each removed secret is stored again untimed.
+void BM_RemoveSecretBySize(benchmark::State& state) {
+    auto sk = createVaultNamespace("bench_remove_size");
+    const std::string value(static_cast<std::size_t>(state.range(0)), 'x');
+    for (auto _ : state) {
+        state.PauseTiming();
+        sk->storeSecret("victim", value);
+        state.ResumeTiming();
+        sk->removeSecret("victim");
+    }
+}
+BENCHMARK(BM_RemoveSecretBySize)->Apply(valueSizes)->Unit(benchmark::kMicrosecond);
+
+// Arguments: value size in KiB.
+void BM_StreamSecret(benchmark::State& state) {
+    auto sk = createVaultNamespace("bench_stream");
+    const std::vector<std::byte> value(static_cast<std::size_t>(state.range(0)) * 1024, std::byte{'x'});
+    std::vector<std::byte> buffer(16 * 1024);
+    for (auto _ : state) {
+        auto writer = sk->openSecretWriter("stream");
+        writer->write(value);
+        writer->commit();
+        auto reader = sk->openSecretReader("stream");
+        while (reader->read(buffer).value_or(0) > 0) {
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(value.size()));
+}
+BENCHMARK(BM_StreamSecret)->Arg(64)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+void BM_RetrieveSecretCached(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    auto sk = createVaultNamespace("bench_retrieve_cached");
+    for (int i = 0; i < count; ++i) {
+        sk->storeSecret(secretName(i), std::string(64, 'x'));
+    }
+    sk->enableCache();
+
+    int next = 0;
+    for (auto _ : state) {
+        auto value = sk->retrieveSecret(secretName(next));
+        benchmark::DoNotOptimize(value);
+        next = (next + 1) % count;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RetrieveSecretCached)->Arg(1)->Arg(100);
+
+// Probe for names that do not exist, through both APIs.
+void BM_RetrieveMissingSecret(benchmark::State& state) {
+    auto sk = createVaultNamespace("bench_retrieve_missing");
+    sk->storeSecret(secretName(0), std::string(64, 'x'));
+
+    for (auto _ : state) {
+        auto value = sk->retrieveSecret("missing");
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(BM_RetrieveMissingSecret);
+
+void BM_TryRetrieveMissingSecret(benchmark::State& state) {
+    auto sk = createVaultNamespace("bench_try_retrieve_missing");
+    sk->storeSecret(secretName(0), std::string(64, 'x'));
+
+    for (auto _ : state) {
+        auto value = sk->tryRetrieveSecret("missing");
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(BM_TryRetrieveMissingSecret);
+
+// One shared instance, read from a growing number of threads.
+void BM_RetrieveSecretConcurrent(benchmark::State& state) {
+    static constexpr int count = 100;
+    static SafeKeeping::ptr_t sk;
+    if (state.thread_index() == 0) {
+        sk = createVaultNamespace("bench_retrieve_concurrent");
+        for (int i = 0; i < count; ++i) {
+            sk->storeSecret(secretName(i), std::string(64, 'x'));
+        }
+    }
+
+    int next = static_cast<int>(state.thread_index());
+    for (auto _ : state) {
+        auto value = sk->retrieveSecret(secretName(next));
+        benchmark::DoNotOptimize(value);
+        next = (next + 1) % count;
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        sk.reset();
+    }
+}
+BENCHMARK(BM_RetrieveSecretConcurrent)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_RetrieveSecretsBatched(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    auto sk = createVaultNamespace("bench_retrieve_batched");
+    std::vector<std::string> names;
+    SafeKeeping::WriteBatch batch;
+    for (int i = 0; i < count; ++i) {
+        names.push_back(secretName(i));
+        batch.store(names.back(), std::string(64, 'x'));
+    }
+    sk->apply(batch);
+    const std::vector<std::string_view> views(names.begin(), names.end());
+
+    for (auto _ : state) {
+        auto values = sk->retrieveSecrets(views);
+        benchmark::DoNotOptimize(values);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_RetrieveSecretsBatched)->Arg(50);
+
+// Arguments: entry count, scan workers.
+void BM_ListSecrets(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    auto sk = createVaultNamespace("bench_list_" + std::to_string(count));
+    SafeKeeping::WriteBatch batch;
+    for (int i = 0; i < count; ++i) {
+        batch.storeWithDescription(secretName(i), std::string(64, 'x'), "description");
+    }
+    sk->apply(batch);
+    sk->setScanWorkers(static_cast<std::size_t>(state.range(1)));
+
+    for (auto _ : state) {
+        auto list = sk->listSecrets();
+        benchmark::DoNotOptimize(list);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ListSecrets)
+    ->ArgsProduct({{1000, 10000, 100000}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_StoreSecretsIndividually(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    auto sk = createVaultNamespace("bench_store_individually");
+    for (auto _ : state) {
+        for (int i = 0; i < count; ++i) {
+            sk->storeSecret(secretName(i), std::string(64, 'x'));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_StoreSecretsIndividually)->Arg(100)->Unit(benchmark::kMillisecond);
+
+// Arguments: secrets per iteration, durability (0 = Full, 1 = Normal,
+// 2 = Deferred). Deferred includes the final flush().
+void BM_StoreSecretsDurability(benchmark::State& state) {
+    environment();
+    const auto count = static_cast<int>(state.range(0));
+    const auto durability = static_cast<SafeKeeping::Durability>(state.range(1));
+    const std::string name = "bench_store_durability";
+    SafeKeeping::removeNamespace(name);
+    SafeKeeping::CreateOptions options;
+    options.open.durability = durability;
+    auto sk = SafeKeeping::createNew(name, options).instance;
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; ++i) {
+            sk->storeSecret(secretName(i), std::string(64, 'x'));
+        }
+        sk->flush();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_StoreSecretsDurability)
+    ->ArgsProduct({{100}, {0, 1, 2}})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_StoreSecretsInBatch(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    auto sk = createVaultNamespace("bench_store_batch");
+    for (auto _ : state) {
+        SafeKeeping::WriteBatch batch;
+        for (int i = 0; i < count; ++i) {
+            batch.store(secretName(i), std::string(64, 'x'));
+        }
+        sk->apply(batch);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_StoreSecretsInBatch)->Arg(100)->Unit(benchmark::kMillisecond);
+
+// Arguments: 0 = system vault, 1 = passphrase, 2 = recovery key.
+void BM_Unlock(benchmark::State& state) {
+    const auto& ns = slottedNamespace();
+    auto sk = openLocked(ns.name);
+    const auto method = state.range(0);
+    for (auto _ : state) {
+        bool unlocked = false;
+        switch (method) {
+        case 0:
+            unlocked = sk->unlockWithSystemVault();
+            break;
+        case 1:
+            unlocked = sk->unlockWithPassphrase(ns.passphrase);
+            break;
+        default:
+            unlocked = sk->unlockWithRecoveryKey(ns.recoveryKey);
+            break;
+        }
+        if (!unlocked) {
+            state.SkipWithError("unlock failed");
+            break;
+        }
+        sk->lock();
+    }
+    state.SetLabel(method == 0 ? "vault" : method == 1 ? "passphrase" : "recovery");
+}
+BENCHMARK(BM_Unlock)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+void BM_CreateNamespace(benchmark::State& state) {
+    environment();
+    const std::string name = "bench_create";
+    SafeKeeping::removeNamespace(name);
+    for (auto _ : state) {
+        auto sk = createVaultNamespace(name);
+        benchmark::DoNotOptimize(sk);
+        state.PauseTiming();
+        sk.reset();
+        SafeKeeping::removeNamespace(name);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_CreateNamespace)->Unit(benchmark::kMillisecond);
+
+// Opening without unlocking. Connection setup and the schema check wait
+// for the first call.
+void BM_OpenNamespace(benchmark::State& state) {
+    const auto& ns = slottedNamespace();
+    for (auto _ : state) {
+        auto sk = openLocked(ns.name);
+        benchmark::DoNotOptimize(sk);
+    }
+}
+BENCHMARK(BM_OpenNamespace)->Unit(benchmark::kMicrosecond);
+
+// Opening plus the first call, which pays for what open() deferred.
+void BM_OpenNamespaceFirstUse(benchmark::State& state) {
+    const auto& ns = slottedNamespace();
+    for (auto _ : state) {
+        auto sk = openLocked(ns.name);
+        benchmark::DoNotOptimize(sk->availableUnlockMethods());
+    }
+}
+BENCHMARK(BM_OpenNamespaceFirstUse)->Unit(benchmark::kMicrosecond);
+
+// open(name) with default options, which tries the system vault and so sets
+// up the database before returning.
+void BM_OpenNamespaceDefault(benchmark::State& state) {
+    const auto& ns = slottedNamespace();
+    for (auto _ : state) {
+        auto sk = SafeKeeping::open(ns.name);
+        benchmark::DoNotOptimize(sk);
+    }
+}
+BENCHMARK(BM_OpenNamespaceDefault)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
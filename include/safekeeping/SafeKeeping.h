@@ -1,15 +1,128 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <future>
 #include <memory>
 #include <optional>
 #include <span>
+#include <stop_token>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace jgaa::safekeeping {
 
+/**
+ * @brief Error wrapper used to construct a failed Result.
+ *
+ * Mirrors `std::unexpected` for C++20 builds.
+ */
+template <typename E>
+class Unexpected {
+public:
+    explicit Unexpected(E error) : error_(std::move(error)) {}
+
+    [[nodiscard]] const E& error() const& noexcept { return error_; }
+    [[nodiscard]] E&& error() && noexcept { return std::move(error_); }
+
+private:
+    E error_;
+};
+
+/**
+ * @brief Value-or-error return type for the non-throwing API.
+ *
+ * A small subset of `std::expected`. Accessing the value of a failed result,
+ * or the error of a successful one, is undefined behavior.
+ */
+template <typename T, typename E>
+class Result {
+public:
+    Result(T value) : state_(std::in_place_index<0>, std::move(value)) {}
+    Result(Unexpected<E> error) : state_(std::in_place_index<1>, std::move(error).error()) {}
+
+    [[nodiscard]] bool has_value() const noexcept { return state_.index() == 0; }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    [[nodiscard]] T& value() & { return *std::get_if<0>(&state_); }
+    [[nodiscard]] const T& value() const& { return *std::get_if<0>(&state_); }
+    [[nodiscard]] T&& value() && { return std::move(*std::get_if<0>(&state_)); }
+    [[nodiscard]] T& operator*() & { return value(); }
+    [[nodiscard]] const T& operator*() const& { return value(); }
+    [[nodiscard]] T&& operator*() && { return std::move(*this).value(); }
+    [[nodiscard]] T* operator->() { return &value(); }
+    [[nodiscard]] const T* operator->() const { return &value(); }
+
+    template <typename U>
+    [[nodiscard]] T value_or(U&& fallback) const& {
+        return has_value() ? value() : static_cast<T>(std::forward<U>(fallback));
+    }
+
+    [[nodiscard]] const E& error() const& { return *std::get_if<1>(&state_); }
+    [[nodiscard]] E&& error() && { return std::move(*std::get_if<1>(&state_)); }
+
+private:
+    std::variant<T, E> state_;
+};
+
+/** @brief Result of an operation that yields no value. */
+template <typename E>
+class Result<void, E> {
+public:
+    Result() = default;
+    Result(Unexpected<E> error) : error_(std::move(error).error()) {}
+
+    [[nodiscard]] bool has_value() const noexcept { return !error_.has_value(); }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    [[nodiscard]] const E& error() const& { return *error_; }
+    [[nodiscard]] E&& error() && { return std::move(*error_); }
+
+private:
+    std::optional<E> error_;
+};
+
+/**
+ * @brief Owned buffer in guarded memory, used to return secret values.
+ *
+ * The memory comes from `sodium_malloc()`: it is locked into RAM where the
+ * platform allows it, surrounded by guard pages, and wiped when the buffer is
+ * destroyed. Move-only.
+ */
+class SecureBuffer {
+public:
+    SecureBuffer() noexcept = default;
+    /** @brief Allocate `size` bytes of guarded memory. Throws `std::bad_alloc` on failure. */
+    explicit SecureBuffer(std::size_t size);
+    SecureBuffer(SecureBuffer&& other) noexcept;
+    SecureBuffer& operator=(SecureBuffer&& other) noexcept;
+    SecureBuffer(const SecureBuffer&) = delete;
+    SecureBuffer& operator=(const SecureBuffer&) = delete;
+    ~SecureBuffer();
+
+    [[nodiscard]] std::byte* data() noexcept { return data_; }
+    [[nodiscard]] const std::byte* data() const noexcept { return data_; }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    /** @brief The contents as bytes. */
+    [[nodiscard]] std::span<std::byte> span() noexcept;
+    /** @brief The contents as bytes. */
+    [[nodiscard]] std::span<const std::byte> span() const noexcept;
+    /** @brief The contents as text. */
+    [[nodiscard]] std::string_view view() const noexcept;
+
+private:
+    std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
 /**
  * @brief Secure per-namespace secret storage with application-layer encryption.
  *
@@ -19,6 +132,10 @@ namespace jgaa::safekeeping {
  *
  * Instance methods follow a `bool`/value-returning style. On failure they
  * return `false` or an empty optional and record details in latestError().
+ *
+ * One instance may be shared between threads. Reads run concurrently on a
+ * pool of read-only database connections, writes are serialized, and
+ * latestError() reports the last operation of the calling thread.
  */
 class SafeKeeping {
 public:
@@ -51,6 +168,10 @@ public:
         DataCorrupted,
         /** An unexpected internal failure occurred. */
         InternalError,
+        /** The operation was cancelled before it completed. */
+        Cancelled,
+        /** The instance was opened read-only and the call would modify the namespace. */
+        ReadOnly,
     };
 
     /** @brief Details about the most recent instance-level failure. */
@@ -61,6 +182,13 @@ public:
         std::string message;
     };
 
+    /** @brief Error details carried by a failed result_t. */
+    using ErrorInfo = LatestError;
+
+    /** @brief Return type of the non-throwing `try*` API. */
+    template <typename T>
+    using result_t = Result<T, ErrorInfo>;
+
     /** @brief Metadata for a stored secret. */
     struct Info {
         /** Secret name. */
@@ -69,6 +197,115 @@ public:
         std::string description;
     };
 
+    /** @brief How writes are made durable. */
+    enum class Durability {
+        /** Each write is its own transaction, synced to disk before it returns. */
+        Full,
+        /**
+         * Each write commits at once but is not synced. A power loss may drop
+         * the latest commits; the database stays consistent.
+         */
+        Normal,
+        /**
+         * Writes are grouped into one transaction that is committed and synced
+         * once per OpenOptions::groupCommitWindow, by flush(), by lock() and on
+         * destruction. A crash loses writes that were not committed yet.
+         * A background commit that fails for a reason other than a busy
+         * database rolls the group back; the next flush(), lock() or write
+         * fails with Error::StorageError to report it.
+         */
+        Deferred,
+    };
+
+    /** @brief Where namespaces are stored on disk. */
+    enum class StoreLayout {
+        /** A directory with its own `vault.db` per namespace. The default. */
+        PerNamespace,
+        /**
+         * Every namespace in one `shared-vault.db` in the data directory,
+         * told apart by a namespace id. Each keeps its own DEK and slots.
+         */
+        Shared,
+    };
+
+    /** @brief Argon2id cost presets for passphrase and recovery key slots. */
+    enum class KdfProfile {
+        /** libsodium's interactive limits: 64 MiB, about 0.1-0.5 s. The default. */
+        Interactive,
+        /** libsodium's moderate limits: 256 MiB, about 0.7 s. */
+        Moderate,
+        /** libsodium's sensitive limits: 1 GiB, several seconds. */
+        Sensitive,
+        /** The smallest limits libsodium accepts. Only for tests. */
+        Minimal,
+        /**
+         * Interactive memory, with the operation count measured on this
+         * machine to take about KdfOptions::targetLatency, but never less
+         * than Interactive. Measured once per process and target. Since
+         * the measurement varies between runs, an unlock only rewraps a
+         * slot whose cost is more than a quarter below it.
+         */
+        Calibrated,
+    };
+
+    /** @brief Key derivation settings for passphrase and recovery key slots. */
+    struct KdfOptions {
+        /** Cost preset. */
+        KdfProfile profile = KdfProfile::Interactive;
+        /** Unlock latency aimed for by KdfProfile::Calibrated. */
+        std::chrono::milliseconds targetLatency{500};
+    };
+
+    /** @brief What the audit log does with a record when its buffer is full. */
+    enum class AuditOverflow {
+        /** Drop the record and count it. The call is never delayed. */
+        Drop,
+        /** Wait for the writer to make room. */
+        Block,
+    };
+
+    /** @brief Settings for the encrypted audit log. */
+    struct AuditOptions {
+        /** Records buffered in memory, rounded up to a power of two. */
+        std::size_t capacity = 4096;
+        /** Policy when the buffer is full. */
+        AuditOverflow overflow = AuditOverflow::Drop;
+        /** How often buffered records are written to the log. */
+        std::chrono::milliseconds flushInterval{100};
+    };
+
+    /** @brief Storage options applied when a namespace is created or opened. */
+    struct OpenOptions {
+        /** Write durability for this instance. */
+        Durability durability = Durability::Full;
+        /** How long Deferred mode collects writes before committing them. */
+        std::chrono::milliseconds groupCommitWindow{50};
+        /**
+         * Key derivation cost for slots this instance creates. When set, a
+         * passphrase or recovery key slot unlocked with a known secret but
+         * created with other limits is rewrapped with these limits in the
+         * background. When unset, new slots use KdfProfile::Interactive and
+         * existing slots are left as they are.
+         */
+        std::optional<KdfOptions> kdf;
+        /**
+         * Record every store, retrieve, remove, list and unlock attempt of
+         * this instance in `audit.log` in the namespace directory. Off when
+         * unset.
+         */
+        std::optional<AuditOptions> audit;
+        /**
+         * Open for reading only. The instance never opens a writable
+         * connection, takes the database write lock or changes file
+         * permissions, and reads pages through memory-mapped I/O. Calls that
+         * would modify the namespace fail with Error::ReadOnly before doing
+         * any work. A database that needs a schema migration cannot be
+         * opened this way, and `kdf` does not rewrap slots. Not valid for
+         * createNew() or together with `audit`.
+         */
+        bool readOnly = false;
+    };
+
     /** @brief Options for createNew() and openOrCreate() when creation is required. */
     struct CreateOptions {
         /** Create a system-vault-backed unlock slot when available. */
@@ -79,6 +316,8 @@ public:
         bool createRecoveryKey = false;
         /** Require that at least one unlock method is configured. */
         bool requireAtLeastOneUnlockMethod = true;
+        /** Storage options for the returned instance. */
+        OpenOptions open;
     };
 
     /** @brief Options for opening and attempting to unlock an existing namespace. */
@@ -89,6 +328,8 @@ public:
         std::optional<std::string> passphrase;
         /** Optional recovery key to try if earlier methods do not succeed. */
         std::optional<std::string> recoveryKey;
+        /** Storage options for the returned instance. */
+        OpenOptions open;
     };
 
     /** @brief Result returned when a new namespace is created. */
@@ -112,6 +353,183 @@ public:
     /** @brief List of secret metadata entries. */
     using info_list_t = std::vector<Info>;
 
+    /**
+     * @brief Options for forEachSecret() and listSecretsPage().
+     *
+     * These calls return entries in storage order. Storage order follows the
+     * keyed name hash, so it is stable but not alphabetical.
+     */
+    struct ListOptions {
+        /** Decrypt descriptions. When `false`, Info::description is left empty. */
+        bool includeDescriptions = true;
+        /** Maximum number of entries to return. `0` means no limit. */
+        std::size_t limit = 0;
+        /** Continue after this position, taken from ListPage::nextCursor. Empty starts at the beginning. */
+        std::string cursor;
+    };
+
+    /** @brief One page of entries from listSecretsPage(). */
+    struct ListPage {
+        /** Entries in storage order. */
+        info_list_t entries;
+        /** Cursor for the next page, or empty when this is the last page. */
+        std::optional<std::string> nextCursor;
+    };
+
+    /** @brief Called once per entry by forEachSecret(). Return `false` to stop. */
+    using list_visitor_t = std::function<bool(const Info&)>;
+
+    /** @brief Per-name result from retrieveSecrets(). */
+    struct SecretLookup {
+        /** Requested secret name. */
+        std::string name;
+        /** Secret value, set when `error` is Error::None. */
+        std::optional<std::vector<std::byte>> value;
+        /** Why the value is missing: NotFound, InvalidArgument, DataCorrupted or StorageError. */
+        Error error = Error::None;
+    };
+
+    /** @brief Results from retrieveSecrets(), in request order. */
+    using lookup_list_t = std::vector<SecretLookup>;
+
+    /**
+     * @brief Store and remove operations applied together by apply().
+     *
+     * The batch copies names and values when operations are added. Secret
+     * values are wiped from memory when the batch is cleared or destroyed.
+     * Nothing is validated until the batch is applied.
+     */
+    class WriteBatch {
+    public:
+        WriteBatch();
+        WriteBatch(const WriteBatch&) = delete;
+        WriteBatch& operator=(const WriteBatch&) = delete;
+        /** @brief Move-construct a batch. */
+        WriteBatch(WriteBatch&&) noexcept;
+        /** @brief Move-assign a batch. */
+        WriteBatch& operator=(WriteBatch&&) noexcept;
+        /** @brief Destroy the batch and wipe queued secret values. */
+        ~WriteBatch();
+
+        /** @brief Queue storing or replacing a text secret. */
+        WriteBatch& store(std::string_view name, std::string_view secret);
+        /** @brief Queue storing or replacing a binary secret. */
+        WriteBatch& store(std::string_view name, std::span<const std::byte> secret);
+        /** @brief Queue storing or replacing a text secret with a description. */
+        WriteBatch& storeWithDescription(std::string_view name,
+                                         std::string_view secret,
+                                         std::string_view description);
+        /** @brief Queue storing or replacing a binary secret with a description. */
+        WriteBatch& storeWithDescription(std::string_view name,
+                                         std::span<const std::byte> secret,
+                                         std::string_view description);
+        /** @brief Queue removing a secret. */
+        WriteBatch& remove(std::string_view name);
+
+        /** @brief Number of queued operations. */
+        [[nodiscard]] std::size_t size() const noexcept;
+        /** @brief Check whether the batch has no queued operations. */
+        [[nodiscard]] bool empty() const noexcept;
+        /** @brief Drop all queued operations and wipe their values. */
+        void clear() noexcept;
+
+    private:
+        friend class SafeKeeping;
+        struct Operation;
+        using operations_t = std::vector<Operation>;
+
+        operations_t operations_;
+    };
+
+    /**
+     * @brief Incremental writer for a secret of any size.
+     *
+     * Obtained from openSecretWriter(). Data is encrypted and stored in 64 KiB
+     * chunks as it is written, so only one chunk is held in memory. The secret
+     * becomes visible, replacing any previous value, when commit() succeeds.
+     * Destroying a writer before commit() discards what was written.
+     *
+     * A writer belongs to the instance that created it and must not outlive
+     * it. Errors are reported through that instance's latestError().
+     */
+    class SecretWriter {
+    public:
+        SecretWriter(const SecretWriter&) = delete;
+        SecretWriter& operator=(const SecretWriter&) = delete;
+        ~SecretWriter();
+
+        /**
+         * @brief Append data to the secret.
+         * @return `true` on success, otherwise `false` and latestError() is updated.
+         */
+        bool write(std::span<const std::byte> data);
+        /** @brief Append text to the secret. */
+        bool write(std::string_view data);
+        /**
+         * @brief Store the written data as the secret's value.
+         * @return `true` on success, otherwise `false` and latestError() is updated.
+         */
+        bool commit();
+        /** @brief Number of bytes written so far. */
+        [[nodiscard]] std::uint64_t size() const noexcept;
+
+    private:
+        friend class SafeKeeping;
+        struct State;
+
+        explicit SecretWriter(std::unique_ptr<State> state);
+
+        std::unique_ptr<State> state_;
+    };
+
+    /**
+     * @brief Sequential and random-access reader for a stored secret.
+     *
+     * Obtained from openSecretReader(). Works for every secret, but only
+     * decrypts the chunks that are read, which makes it the way to read
+     * secrets stored with a SecretWriter that are larger than the 10 KiB
+     * limit of retrieveSecret(). If the secret is replaced or removed while
+     * the reader is open, reading chunks that were not loaded yet fails with
+     * Error::NotFound.
+     *
+     * A reader belongs to the instance that created it and must not outlive
+     * it. Errors are reported through that instance's latestError().
+     */
+    class SecretReader {
+    public:
+        SecretReader(const SecretReader&) = delete;
+        SecretReader& operator=(const SecretReader&) = delete;
+        ~SecretReader();
+
+        /** @brief Total size of the secret in bytes. */
+        [[nodiscard]] std::uint64_t size() const noexcept;
+        /** @brief Current read position. */
+        [[nodiscard]] std::uint64_t tell() const noexcept;
+        /**
+         * @brief Move the read position.
+         * @return `true` on success, otherwise `false` and latestError() is updated.
+         */
+        bool seek(std::uint64_t offset);
+        /**
+         * @brief Read from the current position and advance it.
+         * @return Bytes read, `0` at the end, or an empty optional on failure.
+         */
+        std::optional<std::size_t> read(std::span<std::byte> out);
+        /**
+         * @brief Read from `offset` without moving the read position.
+         * @return Bytes read, `0` at or past the end, or an empty optional on failure.
+         */
+        std::optional<std::size_t> readAt(std::uint64_t offset, std::span<std::byte> out);
+
+    private:
+        friend class SafeKeeping;
+        struct State;
+
+        explicit SecretReader(std::unique_ptr<State> state);
+
+        std::unique_ptr<State> state_;
+    };
+
     SafeKeeping(const SafeKeeping&) = delete;
     SafeKeeping& operator=(const SafeKeeping&) = delete;
     /** @brief Move-construct a `SafeKeeping` instance. */
@@ -138,6 +556,11 @@ public:
     static CreateResult createNew(std::string namespaceName, CreateOptions options);
     /**
      * @brief Open an existing namespace without explicit unlock options.
+     *
+     * Uses default UnlockOptions, so it attempts a system-vault unlock,
+     * which opens and checks the database before returning. To defer that
+     * to the first call, use open(namespaceName, options) with
+     * `trySystemVaultFirst` false and no credentials.
      * @param namespaceName Namespace identifier.
      * @return Opened instance, or `nullptr` if the namespace does not exist.
      * @throws std::exception on open or schema failure.
@@ -148,7 +571,9 @@ public:
      * @param namespaceName Namespace identifier.
      * @param options Unlock attempts to perform while opening.
      * @return Opened instance, or `nullptr` if the namespace does not exist.
-     * @throws std::exception on open or schema failure.
+     * @throws std::exception on open or schema failure. Unless an unlock is
+     *         attempted, the database is only opened and checked by the
+     *         first call that uses it.
      */
     static ptr_t open(std::string namespaceName, UnlockOptions options);
     /**
@@ -161,11 +586,70 @@ public:
     /**
      * @brief Open an existing namespace or create it with explicit options.
      * @param namespaceName Namespace identifier.
-     * @param options Creation options used only when the namespace does not exist.
+     * @param options Creation options used only when the namespace does not
+     *        exist. `options.open` applies in both cases.
      * @return Opened or newly created instance.
      * @throws std::exception on open or creation failure.
      */
     static ptr_t openOrCreate(std::string namespaceName, CreateOptions options);
+    /**
+     * @brief Open a namespace through the process-wide handle registry.
+     * @param namespaceName Namespace identifier.
+     * @return Shared instance, or `nullptr` if the namespace does not exist.
+     * @throws std::exception on open or schema failure.
+     *
+     * Components that open the same namespace share one instance, with one
+     * database connection and one unlocked key, for as long as any handle
+     * is alive. Only the first call opens the database; later calls
+     * return the same instance, and its `options.open` settings stay in
+     * effect.
+     */
+    static std::shared_ptr<SafeKeeping> openShared(std::string namespaceName);
+    /**
+     * @brief Open a namespace through the registry and try to unlock it.
+     * @param namespaceName Namespace identifier.
+     * @param options Unlock attempts. They only run if the shared instance
+     *        is locked, and their outcome is reported by latestError().
+     * @return Shared instance, or `nullptr` if the namespace does not exist.
+     * @throws std::exception on open or schema failure.
+     */
+    static std::shared_ptr<SafeKeeping> openShared(std::string namespaceName, UnlockOptions options);
+    /**
+     * @brief Lock every instance in this process, shared or not.
+     * @return Number of instances that were unlocked.
+     *
+     * Pending Deferred writes are committed first, as by lock().
+     */
+    static std::size_t lockAll();
+    /**
+     * @brief Open and unlock an existing namespace on a background thread.
+     * @param namespaceName Namespace identifier.
+     * @param options Unlock attempts to perform while opening.
+     * @param stop Requests cancellation.
+     * @return Future holding the opened instance or the error.
+     *
+     * Runs open() on a shared background executor, so the vault lookup and
+     * the passphrase or recovery key derivation do not block the caller.
+     * As with open(), an instance is returned even if no unlock attempt
+     * succeeds; use unlockAsync() to learn why. A missing namespace is
+     * reported as Error::NotFound.
+     *
+     * Cancellation is checked between steps. A key derivation that is
+     * already running completes, but its result is discarded and the call
+     * reports Error::Cancelled.
+     */
+    static std::future<result_t<ptr_t>> openAsync(std::string namespaceName,
+                                                  UnlockOptions options,
+                                                  std::stop_token stop = {});
+    /**
+     * @brief Like openAsync(), but reports the result to a callback.
+     *
+     * `done` runs on the background executor and must not block for long.
+     */
+    static void openAsync(std::string namespaceName,
+                          UnlockOptions options,
+                          std::function<void(result_t<ptr_t>)> done,
+                          std::stop_token stop = {});
     /**
      * @brief Set the Linux system-vault root name used for libsecret entries.
      *
@@ -185,6 +669,39 @@ public:
      * @return The current Linux vault root name.
      */
     [[nodiscard]] static std::string linuxVaultRootName();
+    /**
+     * @brief Set the deadline for each call to the system vault.
+     *
+     * On Linux, a Secret Service call that takes longer is cancelled and
+     * the operation fails with `VaultError`. Unlock prompts shown by the
+     * keyring count against the deadline. The default is 10 seconds. The
+     * macOS and Windows backends call synchronous OS APIs and ignore it.
+     *
+     * @param timeout Positive timeout.
+     * @throws std::exception if the timeout is not positive or too large.
+     */
+    static void setSystemVaultTimeout(std::chrono::milliseconds timeout);
+    /**
+     * @brief Get the deadline for each call to the system vault.
+     * @return The current timeout.
+     */
+    [[nodiscard]] static std::chrono::milliseconds systemVaultTimeout();
+    /**
+     * @brief Select the store used by later createNew(), open(), exists() and removeNamespace() calls.
+     *
+     * Instances that are already open keep using the store they were opened
+     * from. Namespaces are not moved between layouts, and a name that exists
+     * in either layout cannot be created in the other, since both share the
+     * system-vault entry for that name.
+     *
+     * @param layout Store layout.
+     */
+    static void setStoreLayout(StoreLayout layout);
+    /**
+     * @brief Get the store layout used for namespaces.
+     * @return The current layout.
+     */
+    [[nodiscard]] static StoreLayout storeLayout();
     /**
      * @brief Check whether a namespace database exists.
      * @param namespaceName Namespace identifier.
@@ -198,6 +715,19 @@ public:
      * @throws std::exception on invalid namespace names.
      */
     static bool removeNamespace(std::string namespaceName);
+    /**
+     * @brief Fetch the system-vault material of many namespaces at once.
+     * @param namespaceNames Namespaces that will be unlocked soon.
+     * @return Number of namespaces whose material was found.
+     * @throws std::exception on invalid namespace names.
+     *
+     * On Linux this is one Secret Service search for every item under
+     * linuxVaultRootName(). The material is kept in guarded memory and
+     * serves the next system-vault unlock of each namespace, which then
+     * needs no vault round trip. Each entry is wiped once it is used.
+     * Namespaces that are not found unlock through the vault as usual.
+     */
+    static std::size_t prefetchVaultMaterial(std::span<const std::string> namespaceNames);
 
     /** @brief Get the namespace name for this instance. */
     [[nodiscard]] const std::string& namespaceName() const noexcept;
@@ -221,11 +751,44 @@ public:
      * @return `true` on success, otherwise `false` and latestError() is updated.
      */
     bool unlockWithRecoveryKey(std::string_view recoveryKey);
+    /**
+     * @brief Unlock on a background thread.
+     * @param options Unlock attempts, tried in the same order as open().
+     *        `options.open` is ignored.
+     * @param stop Requests cancellation.
+     * @return Future that is ready once the namespace is unlocked, or holds
+     *         the error of the last failed attempt.
+     *
+     * Cancellation works as for openAsync(); a cancelled call leaves the
+     * namespace locked. Destroying the instance waits for pending calls.
+     */
+    std::future<result_t<void>> unlockAsync(UnlockOptions options, std::stop_token stop = {});
+    /**
+     * @brief Like unlockAsync(), but reports the result to a callback.
+     *
+     * `done` runs on the background executor and may destroy the instance.
+     */
+    void unlockAsync(UnlockOptions options,
+                     std::function<void(result_t<void>)> done,
+                     std::stop_token stop = {});
     /**
      * @brief Lock the namespace and clear in-memory key material.
      * @return `true` on success.
+     *
+     * Pending Deferred writes are committed first. If that commit fails the
+     * namespace is still locked and `false` is returned. The writes stay
+     * pending for the next attempt only if the database was busy; any other
+     * failure rolls them back.
      */
     bool lock();
+    /**
+     * @brief Commit writes that Deferred durability is still holding back.
+     * @return `true` on success, otherwise `false` and latestError() is updated.
+     *
+     * Does nothing with Full or Normal durability. Also reports a background
+     * commit that rolled back earlier writes.
+     */
+    bool flush();
 
     /**
      * @brief Store or replace a text secret.
@@ -261,6 +824,17 @@ public:
     bool storeSecretWithDescription(std::string_view name,
                                     std::span<const std::byte> secret,
                                     std::string_view description);
+    /**
+     * @brief Apply a batch of store and remove operations atomically.
+     * @param batch Operations to apply, in order.
+     * @return `true` on success, otherwise `false` and latestError() is updated.
+     *
+     * Every operation is validated and encrypted before the database is
+     * touched. All of them are then committed in a single transaction, with one
+     * metadata update and one durable sync. If any operation fails, for
+     * example removing a secret that does not exist, nothing is applied.
+     */
+    bool apply(const WriteBatch& batch);
     /**
      * @brief Retrieve a secret as a string.
      * @param name Secret name.
@@ -277,12 +851,89 @@ public:
      * On failure or if the secret does not exist, latestError() is updated.
      */
     std::optional<std::vector<std::byte>> retrieveSecretBytes(std::string_view name) const;
+    /**
+     * @brief Retrieve a secret into a caller-supplied buffer.
+     * @param name Secret name.
+     * @param out Destination. Must be at least as large as the secret.
+     * @return Number of bytes written on success, otherwise an empty optional.
+     *
+     * The value is decrypted directly into `out`, with no intermediate copy.
+     * If `out` is too small, nothing is written and latestError() reports
+     * Error::TooLarge with the required size. Unlike retrieveSecret(), this
+     * also reads streamed secrets larger than 10 KiB.
+     */
+    std::optional<std::size_t> retrieveSecretInto(std::string_view name, std::span<std::byte> out) const;
+    /**
+     * @brief Retrieve a secret into guarded memory.
+     * @param name Secret name.
+     * @return Secret value on success, otherwise an empty optional.
+     *
+     * The value is decrypted directly into a SecureBuffer, which is wiped
+     * when it is destroyed. Like retrieveSecretInto(), this also reads
+     * streamed secrets larger than 10 KiB.
+     */
+    std::optional<SecureBuffer> retrieveSecretSecure(std::string_view name) const;
+    /**
+     * @brief Retrieve several secrets with batched lookups.
+     * @param names Secret names to fetch. Duplicates are allowed.
+     * @return One entry per requested name, in request order, or an empty
+     *         optional if the whole operation failed.
+     *
+     * Missing or invalid names are reported per entry and do not fail the
+     * call. latestError() is only updated for whole-call failures such as a
+     * locked namespace.
+     */
+    std::optional<lookup_list_t> retrieveSecrets(std::span<const std::string_view> names) const;
     /**
      * @brief Remove a stored secret.
      * @param name Secret name.
      * @return `true` on success, otherwise `false` and latestError() is updated.
      */
     bool removeSecret(std::string_view name);
+    /**
+     * @brief Start writing a secret incrementally.
+     * @param name Secret name.
+     * @return Writer on success, otherwise `nullptr` and latestError() is updated.
+     *
+     * Use this for values above the 10 KiB limit of storeSecret().
+     */
+    std::unique_ptr<SecretWriter> openSecretWriter(std::string_view name);
+    /** @brief Start writing a secret incrementally, with a description. */
+    std::unique_ptr<SecretWriter> openSecretWriter(std::string_view name, std::string_view description);
+    /**
+     * @brief Open a secret for sequential or ranged reads.
+     * @param name Secret name.
+     * @return Reader on success, otherwise `nullptr` and latestError() is updated.
+     */
+    std::unique_ptr<SecretReader> openSecretReader(std::string_view name) const;
+
+    /**
+     * @name Result-returning API
+     *
+     * The `try*` methods behave like their counterparts above, but return the
+     * error in the result instead of recording it in latestError(), which
+     * they leave untouched. Expected outcomes such as a missing secret, a
+     * locked namespace or an invalid name are reported without throwing
+     * internally, so these calls are cheap for probe-style lookups where
+     * misses are common.
+     * @{
+     */
+    /** @brief Retrieve a secret as a string. */
+    [[nodiscard]] result_t<std::string> tryRetrieveSecret(std::string_view name) const;
+    /** @brief Retrieve a secret as raw bytes. */
+    [[nodiscard]] result_t<std::vector<std::byte>> tryRetrieveSecretBytes(std::string_view name) const;
+    /** @brief Retrieve a secret into a caller-supplied buffer. */
+    [[nodiscard]] result_t<std::size_t> tryRetrieveSecretInto(std::string_view name,
+                                                             std::span<std::byte> out) const;
+    /** @brief Retrieve a secret into guarded memory. */
+    [[nodiscard]] result_t<SecureBuffer> tryRetrieveSecretSecure(std::string_view name) const;
+    /** @brief Store or replace a text secret. */
+    [[nodiscard]] result_t<void> tryStoreSecret(std::string_view name, std::string_view secret);
+    /** @brief Store or replace a binary secret. */
+    [[nodiscard]] result_t<void> tryStoreSecret(std::string_view name, std::span<const std::byte> secret);
+    /** @brief Remove a stored secret. */
+    [[nodiscard]] result_t<void> tryRemoveSecret(std::string_view name);
+    /** @} */
     /**
      * @brief List all stored secret names and descriptions.
      * @return Sorted list of secret metadata, or an empty list on failure.
@@ -291,8 +942,214 @@ public:
      */
     info_list_t listSecrets() const;
     /**
-     * @brief Get the most recent instance-level error.
-     * @return Error category and message for the last failed operation.
+     * @brief Stream every stored secret to a visitor without building a list.
+     * @param visitor Called once per entry, in storage order.
+     * @return `true` on success or early stop, otherwise `false` and latestError() is updated.
+     */
+    bool forEachSecret(const list_visitor_t& visitor) const;
+    /**
+     * @brief Stream stored secrets to a visitor with explicit options.
+     * @param options Description handling, entry limit and start cursor.
+     * @param visitor Called once per entry, in storage order.
+     * @return `true` on success or early stop, otherwise `false` and latestError() is updated.
+     *
+     * Only one entry is decrypted and held in memory at a time.
+     */
+    bool forEachSecret(const ListOptions& options, const list_visitor_t& visitor) const;
+    /**
+     * @brief List one page of stored secrets.
+     * @param options Page size (`limit`), start cursor and description handling.
+     * @return The page, or an empty optional on failure.
+     *
+     * Pass the returned `nextCursor` in the next call's options to continue.
+     * On failure latestError() is updated.
+     */
+    std::optional<ListPage> listSecretsPage(const ListOptions& options) const;
+    /**
+     * @brief Set how many threads decrypt rows in full-namespace scans.
+     * @param workers `1` (the default) decrypts on the calling thread. `0`
+     *        uses one worker per hardware thread.
+     *
+     * Applies to listSecrets(), forEachSecret() and listSecretsPage(). Rows
+     * are read in chunks, decrypted in parallel and delivered in their
+     * original order. The calling thread is one of the workers.
+     */
+    void setScanWorkers(std::size_t workers);
+
+    /** @brief Limits for the optional cache of decrypted secret values. */
+    struct CacheOptions {
+        /** Maximum number of cached secrets. */
+        std::size_t maxEntries = 256;
+        /** Maximum total size of cached values, in bytes. */
+        std::size_t maxBytes = 1024 * 1024;
+        /** How long a value stays cached after it was read. */
+        std::chrono::steady_clock::duration ttl = std::chrono::seconds{60};
+    };
+
+    /** @brief Counters for the decrypted-value cache. */
+    struct CacheStats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        std::uint64_t expirations = 0;
+        std::size_t entries = 0;
+        std::size_t bytes = 0;
+    };
+
+    /**
+     * @brief Cache decrypted secret values in memory.
+     * @param options Entry, size and time limits. Zero limits disable the cache.
+     *
+     * Off by default. Cached values are kept in guarded memory and served by
+     * retrieveSecret() and retrieveSecretBytes() without a database read or
+     * decryption. Stores and removes through this instance invalidate their
+     * entries, and lock() wipes the whole cache. Writes made by other
+     * processes are only seen once an entry expires.
+     */
+    void enableCache(const CacheOptions& options);
+    /** @brief Cache decrypted secret values with the default CacheOptions limits. */
+    void enableCache();
+    /** @brief Disable the cache and wipe every cached value. */
+    void disableCache();
+    /** @brief Get cache counters. Counters are kept across enable/disable. */
+    [[nodiscard]] CacheStats cacheStats() const;
+
+    /** @brief Public calls counted by stats(). */
+    enum class Operation {
+        /** storeSecret(), tryStoreSecret(), apply() and SecretWriter::commit(). */
+        Store,
+        /** retrieveSecret() and its variants, retrieveSecrets() and openSecretReader(). */
+        Retrieve,
+        /** removeSecret() and tryRemoveSecret(). */
+        Remove,
+        /** listSecrets(), forEachSecret() and listSecretsPage(). */
+        List,
+        /** unlockWithSystemVault(), or the system vault attempt of an open or unlockAsync(). */
+        UnlockSystemVault,
+        /** unlockWithPassphrase(), or the passphrase attempt of an open or unlockAsync(). */
+        UnlockPassphrase,
+        /** unlockWithRecoveryKey(), or the recovery key attempt of an open or unlockAsync(). */
+        UnlockRecoveryKey,
+    };
+
+    /** @brief Where time inside operations is spent. */
+    enum class Phase {
+        /** Stepping SQLite statements. */
+        SqliteStep,
+        /** Beginning and committing transactions, including waits for the database write lock. */
+        SqliteCommit,
+        /** XChaCha20-Poly1305 encryption and decryption. */
+        Aead,
+        /** Argon2id key derivation. */
+        Kdf,
+        /** System vault calls. */
+        Vault,
+    };
+
+    static constexpr std::size_t kOperationCount = static_cast<std::size_t>(Operation::UnlockRecoveryKey) + 1;
+    static constexpr std::size_t kPhaseCount = static_cast<std::size_t>(Phase::Vault) + 1;
+    static constexpr std::size_t kErrorCount = static_cast<std::size_t>(Error::ReadOnly) + 1;
+    /**
+     * @brief Number of latency buckets. Bucket `i` counts calls that took
+     * from 2^i up to 2^(i+1) microseconds; bucket 0 also counts faster calls
+     * and the last bucket has no upper bound.
+     */
+    static constexpr std::size_t kLatencyBuckets = 24;
+
+    /** @brief Counters for one kind of operation. */
+    struct OperationStats {
+        std::uint64_t count = 0;
+        std::uint64_t errors = 0;
+        std::chrono::nanoseconds totalTime{};
+        std::array<std::uint64_t, kLatencyBuckets> latency{};
+    };
+
+    /** @brief Operation, error, phase and SQLite page cache counters. */
+    struct Stats {
+        /** Indexed by Operation. */
+        std::array<OperationStats, kOperationCount> operations{};
+        /** Failed operations, indexed by Error. */
+        std::array<std::uint64_t, kErrorCount> errors{};
+        /** Time spent per phase, indexed by Phase. */
+        std::array<std::chrono::nanoseconds, kPhaseCount> phases{};
+        /** Page cache hits, misses and size of the open connections. */
+        std::uint64_t sqliteCacheHits = 0;
+        std::uint64_t sqliteCacheMisses = 0;
+        std::uint64_t sqliteCacheBytes = 0;
+        /** Connections made to the Linux Secret Service. Only processStats() counts them. */
+        std::uint64_t vaultConnections = 0;
+
+        [[nodiscard]] const OperationStats& operation(Operation op) const {
+            return operations[static_cast<std::size_t>(op)];
+        }
+        [[nodiscard]] std::uint64_t errorCount(Error error) const {
+            return errors[static_cast<std::size_t>(error)];
+        }
+        [[nodiscard]] std::chrono::nanoseconds phase(Phase which) const {
+            return phases[static_cast<std::size_t>(which)];
+        }
+    };
+
+    /**
+     * @brief Get counters for the operations of this instance.
+     *
+     * Always on; counters are relaxed atomics. Phases are counted while an
+     * operation runs, including the attempts of an unlock race. The SQLite
+     * numbers cover the writer connection and the idle read connections.
+     */
+    [[nodiscard]] Stats stats() const;
+    /**
+     * @brief Get counters aggregated over every instance in this process.
+     *
+     * Operation counters include instances that are already destroyed.
+     * Phases also include work outside counted operations, such as opening
+     * or creating a namespace. The SQLite numbers cover open instances.
+     */
+    [[nodiscard]] static Stats processStats();
+
+    /** @brief One entry of the audit log. */
+    struct AuditEvent {
+        std::chrono::system_clock::time_point time;
+        Operation operation = Operation::Store;
+        /** Error::None if the operation succeeded. */
+        Error outcome = Error::None;
+        /** Secret name, empty for unlocks and listings. */
+        std::string name;
+    };
+
+    /** @brief Counters for the audit log. */
+    struct AuditStats {
+        /** Records handed to the log. */
+        std::uint64_t recorded = 0;
+        /** Records appended to the log file. */
+        std::uint64_t written = 0;
+        /** Records dropped because the buffer was full. */
+        std::uint64_t dropped = 0;
+        /** Calls that waited for room under AuditOverflow::Block. */
+        std::uint64_t blocked = 0;
+        /** Records lost because the log file could not be written. */
+        std::uint64_t writeFailures = 0;
+    };
+
+    /**
+     * @brief Get audit log counters. All zero unless OpenOptions::audit is set.
+     *
+     * Records are written by a background thread, in batches, encrypted
+     * with a key derived from the namespace key. While the namespace is
+     * locked they stay buffered, and once the buffer is full they are
+     * dropped under either overflow policy.
+     */
+    [[nodiscard]] AuditStats auditStats() const;
+    /**
+     * @brief Write buffered audit records and read back the whole log.
+     * @return Events in the order they were written, or `std::nullopt` if
+     *         the namespace is locked, auditing is off or the log is
+     *         corrupted.
+     */
+    [[nodiscard]] std::optional<std::vector<AuditEvent>> readAuditLog() const;
+    /**
+     * @brief Get the most recent instance-level error for the calling thread.
+     * @return Error category and message for this thread's last failed operation.
      */
     [[nodiscard]] LatestError latestError() const;
 
@@ -341,6 +1198,7 @@ public:
     bool removeRecoveryKey();
 
 private:
+    friend class SafeKeepingManager;
     class Impl;
 
     explicit SafeKeeping(std::unique_ptr<Impl> impl);
@@ -348,4 +1206,86 @@ private:
     std::unique_ptr<Impl> impl_;
 };
 
+/**
+ * @brief Keeps many namespaces available with a bounded number of open databases.
+ *
+ * get() opens a namespace once and hands out the same instance afterwards.
+ * When more than Options::maxOpenDatabases managed instances hold database
+ * connections, the least recently used one that is idle has its connections
+ * closed. Its handles stay valid: the next call on it reopens them. An
+ * instance in the middle of a write, or with a pending Deferred group, is
+ * not idle and is skipped.
+ *
+ * One manager may be shared between threads. Handles keep working after the
+ * manager is destroyed, but are no longer closed when idle.
+ */
+class SafeKeepingManager {
+public:
+    /** @brief Manager settings. */
+    struct Options {
+        /** Most managed instances with open database connections at a time. */
+        std::size_t maxOpenDatabases = 64;
+        /**
+         * Keep closed instances unlocked, with their keys in guarded memory.
+         * If false, closing also locks them, and get() unlocks them again
+         * with the options it is given.
+         */
+        bool keepUnlocked = true;
+    };
+
+    /** @brief Manager counters. */
+    struct Stats {
+        /** Namespaces held by the manager. */
+        std::size_t namespaces = 0;
+        /** Managed instances with open database connections. */
+        std::size_t openDatabases = 0;
+        /** Instances whose connections were closed to stay under the cap. */
+        std::uint64_t evictions = 0;
+        /** Closed instances whose connections were reopened by a later call. */
+        std::uint64_t reopens = 0;
+        /** Eviction candidates skipped because they were busy. */
+        std::uint64_t busySkips = 0;
+    };
+
+    SafeKeepingManager();
+    explicit SafeKeepingManager(Options options);
+    ~SafeKeepingManager();
+    SafeKeepingManager(const SafeKeepingManager&) = delete;
+    SafeKeepingManager& operator=(const SafeKeepingManager&) = delete;
+
+    /**
+     * @brief Get the managed instance for a namespace, opening it on first use.
+     * @param namespaceName Namespace identifier.
+     * @return The instance, or `nullptr` if the namespace does not exist.
+     * @throws std::exception on invalid names or storage errors, as SafeKeeping::open().
+     */
+    [[nodiscard]] std::shared_ptr<SafeKeeping> get(std::string namespaceName);
+    /**
+     * @brief Get the managed instance for a namespace, opening it on first use.
+     * @param namespaceName Namespace identifier.
+     * @param options Unlock attempts, made when the instance is opened and
+     *        whenever it is locked.
+     * @return The instance, or `nullptr` if the namespace does not exist.
+     * @throws std::exception on invalid names or storage errors, as SafeKeeping::open().
+     */
+    [[nodiscard]] std::shared_ptr<SafeKeeping> get(std::string namespaceName, SafeKeeping::UnlockOptions options);
+    /**
+     * @brief Stop managing a namespace. Handles already given out stay valid.
+     * @return `true` if the manager held it.
+     */
+    bool release(std::string_view namespaceName);
+    /**
+     * @brief Close the connections of every idle managed instance now.
+     * @return Number of instances closed.
+     */
+    std::size_t closeIdle();
+    /** @brief Get manager counters. */
+    [[nodiscard]] Stats stats() const;
+
+private:
+    class Impl;
+
+    std::shared_ptr<Impl> impl_;
+};
+
 } // namespace jgaa::safekeeping
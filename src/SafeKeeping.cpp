@@ -2,20 +2,35 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
 #include <cctype>
 #include <cerrno>
+#include <cstdint>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
+#include <limits>
+#include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <regex>
+#include <set>
+#include <shared_mutex>
 #include <span>
 #include <stdexcept>
+#include <stop_token>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -74,19 +89,108 @@ CREATE TABLE IF NOT EXISTS secrets (
     description_nonce BLOB,
     description_ciphertext BLOB,
     created_at INTEGER NOT NULL,
-    updated_at INTEGER NOT NULL
+    updated_at INTEGER NOT NULL,
+    stream_id BLOB
+);
+
+CREATE TABLE IF NOT EXISTS secret_chunks (
+    stream_id BLOB NOT NULL,
+    chunk_index INTEGER NOT NULL,
+    nonce BLOB NOT NULL,
+    ciphertext BLOB NOT NULL,
+    PRIMARY KEY (stream_id, chunk_index)
+) WITHOUT ROWID;
+)sql";
+
+// Upgrades from schema 1: streamed secrets keep their value in secret_chunks.
+constexpr std::string_view kMigrateSchema1To2 = R"sql(
+ALTER TABLE secrets ADD COLUMN stream_id BLOB;
+
+CREATE TABLE IF NOT EXISTS secret_chunks (
+    stream_id BLOB NOT NULL,
+    chunk_index INTEGER NOT NULL,
+    nonce BLOB NOT NULL,
+    ciphertext BLOB NOT NULL,
+    PRIMARY KEY (stream_id, chunk_index)
+) WITHOUT ROWID;
+
+UPDATE metadata SET schema_version = 2;
+)sql";
+
+// StoreLayout::Shared: kSchema with every row owned by a namespace. Removing
+// a namespace's metadata row removes the rest of it.
+constexpr std::string_view kSharedSchema = R"sql(
+CREATE TABLE IF NOT EXISTS metadata (
+    namespace_id INTEGER PRIMARY KEY AUTOINCREMENT,
+    schema_version INTEGER NOT NULL,
+    created_at INTEGER NOT NULL,
+    updated_at INTEGER NOT NULL,
+    namespace_name TEXT NOT NULL UNIQUE
+);
+
+CREATE TABLE IF NOT EXISTS key_slots (
+    namespace_id INTEGER NOT NULL REFERENCES metadata (namespace_id) ON DELETE CASCADE,
+    slot_id TEXT NOT NULL,
+    slot_type TEXT NOT NULL,
+    status TEXT NOT NULL,
+    kdf_name TEXT,
+    kdf_salt BLOB,
+    kdf_opslimit INTEGER,
+    kdf_memlimit INTEGER,
+    nonce BLOB NOT NULL,
+    wrapped_dek BLOB NOT NULL,
+    created_at INTEGER NOT NULL,
+    updated_at INTEGER NOT NULL,
+    label TEXT,
+    PRIMARY KEY (namespace_id, slot_id)
+);
+
+CREATE TABLE IF NOT EXISTS secrets (
+    namespace_id INTEGER NOT NULL REFERENCES metadata (namespace_id) ON DELETE CASCADE,
+    name_hash BLOB NOT NULL,
+    name_nonce BLOB NOT NULL,
+    name_ciphertext BLOB NOT NULL,
+    value_nonce BLOB NOT NULL,
+    value_ciphertext BLOB NOT NULL,
+    description_nonce BLOB,
+    description_ciphertext BLOB,
+    created_at INTEGER NOT NULL,
+    updated_at INTEGER NOT NULL,
+    stream_id BLOB,
+    PRIMARY KEY (namespace_id, name_hash)
 );
+
+CREATE TABLE IF NOT EXISTS secret_chunks (
+    namespace_id INTEGER NOT NULL REFERENCES metadata (namespace_id) ON DELETE CASCADE,
+    stream_id BLOB NOT NULL,
+    chunk_index INTEGER NOT NULL,
+    nonce BLOB NOT NULL,
+    ciphertext BLOB NOT NULL,
+    PRIMARY KEY (namespace_id, stream_id, chunk_index)
+) WITHOUT ROWID;
 )sql";
 
-constexpr int kSchemaVersion = 1;
+constexpr int kSchemaVersion = 2;
 constexpr std::string_view kDbFileName = "vault.db";
+constexpr std::string_view kSharedDbFileName = "shared-vault.db";
+constexpr std::string_view kAuditLogFileName = "audit.log";
 constexpr std::string_view kVaultEntryName = "namespace-vault-material";
 constexpr std::string_view kSlotStatusActive = "active";
 constexpr std::string_view kSlotTypeVault = "vault";
 constexpr std::string_view kSlotTypePassphrase = "passphrase";
 constexpr std::string_view kSlotTypeRecovery = "recovery";
 constexpr std::size_t kMaxSecretSize = 10 * 1024;
+// Plaintext bytes per chunk of a streamed secret.
+constexpr std::size_t kStreamChunkSize = 64 * 1024;
+constexpr std::size_t kStreamIdBytes = 16;
+// Upper bound for memory-mapped reads by read-only instances. SQLite maps no
+// more than the file size.
+constexpr std::int64_t kReadOnlyMmapSize = 256LL * 1024 * 1024;
 constexpr std::string_view kDefaultLinuxVaultRootName = "com.jgaa.SafeKeeping";
+constexpr std::chrono::milliseconds kDefaultSystemVaultTimeout{10000};
+// How long an unlock lets the system vault try alone before it also starts
+// the passphrase and recovery key derivations.
+constexpr std::chrono::milliseconds kVaultHeadStart{250};
 
 class OperationError : public std::runtime_error {
 public:
@@ -106,6 +210,152 @@ private:
     throw OperationError(error, std::move(message));
 }
 
+// Counters behind stats(). Updates are relaxed atomic adds, cheap enough to
+// leave on in production. A snapshot taken while calls are running may be
+// slightly out of step between counters.
+class Metrics {
+public:
+    void recordOperation(SafeKeeping::Operation operation,
+                         std::chrono::nanoseconds elapsed,
+                         SafeKeeping::Error error) noexcept {
+        auto& counters = operations_[static_cast<std::size_t>(operation)];
+        counters.count.fetch_add(1, std::memory_order_relaxed);
+        counters.nanos.fetch_add(static_cast<std::uint64_t>(elapsed.count()), std::memory_order_relaxed);
+        counters.latency[latencyBucket(elapsed)].fetch_add(1, std::memory_order_relaxed);
+        if (error != SafeKeeping::Error::None) {
+            counters.errors.fetch_add(1, std::memory_order_relaxed);
+            errors_[static_cast<std::size_t>(error)].value.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void recordPhase(SafeKeeping::Phase phase, std::chrono::nanoseconds elapsed) noexcept {
+        phases_[static_cast<std::size_t>(phase)].value.fetch_add(static_cast<std::uint64_t>(elapsed.count()),
+                                                                 std::memory_order_relaxed);
+    }
+
+    void recordVaultConnection() noexcept {
+        vaultConnections_.value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] SafeKeeping::Stats snapshot() const {
+        SafeKeeping::Stats stats;
+        for (std::size_t i = 0; i < operations_.size(); ++i) {
+            const auto& counters = operations_[i];
+            auto& out = stats.operations[i];
+            out.count = counters.count.load(std::memory_order_relaxed);
+            out.errors = counters.errors.load(std::memory_order_relaxed);
+            out.totalTime = std::chrono::nanoseconds{counters.nanos.load(std::memory_order_relaxed)};
+            for (std::size_t bucket = 0; bucket < counters.latency.size(); ++bucket) {
+                out.latency[bucket] = counters.latency[bucket].load(std::memory_order_relaxed);
+            }
+        }
+        for (std::size_t i = 0; i < errors_.size(); ++i) {
+            stats.errors[i] = errors_[i].value.load(std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < phases_.size(); ++i) {
+            stats.phases[i] = std::chrono::nanoseconds{phases_[i].value.load(std::memory_order_relaxed)};
+        }
+        stats.vaultConnections = vaultConnections_.value.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    [[nodiscard]] static std::size_t latencyBucket(std::chrono::nanoseconds elapsed) noexcept {
+        using namespace std::chrono;
+        const auto micros = static_cast<std::uint64_t>(duration_cast<microseconds>(elapsed).count());
+        const auto width = static_cast<std::size_t>(std::bit_width(micros));
+        return std::min<std::size_t>(width == 0 ? 0 : width - 1, SafeKeeping::kLatencyBuckets - 1);
+    }
+
+    // One cache line per operation, so threads timing different operations
+    // do not contend.
+    struct alignas(64) OperationCounters {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> errors{0};
+        std::atomic<std::uint64_t> nanos{0};
+        std::array<std::atomic<std::uint64_t>, SafeKeeping::kLatencyBuckets> latency{};
+    };
+
+    // Likewise for each error category and phase.
+    struct alignas(64) Counter {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    std::array<OperationCounters, SafeKeeping::kOperationCount> operations_{};
+    std::array<Counter, SafeKeeping::kErrorCount> errors_{};
+    std::array<Counter, SafeKeeping::kPhaseCount> phases_{};
+    Counter vaultConnections_;
+};
+
+[[nodiscard]] Metrics& processMetrics() {
+    static Metrics metrics;
+    return metrics;
+}
+
+// Metrics of the instance whose operation runs on this thread, if any.
+thread_local Metrics* operationMetrics = nullptr;
+
+// Attributes phases timed on this thread to `metrics` while it lives.
+class OperationMetricsScope {
+public:
+    explicit OperationMetricsScope(Metrics& metrics) noexcept
+        : previous_(std::exchange(operationMetrics, &metrics)) {}
+
+    OperationMetricsScope(const OperationMetricsScope&) = delete;
+    OperationMetricsScope& operator=(const OperationMetricsScope&) = delete;
+
+    ~OperationMetricsScope() {
+        operationMetrics = previous_;
+    }
+
+private:
+    Metrics* previous_;
+};
+
+// Adds the time of one phase to the process metrics and to the instance
+// whose operation is running on this thread.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(SafeKeeping::Phase phase) noexcept
+        : phase_(phase),
+          started_(std::chrono::steady_clock::now()) {}
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    ~PhaseTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - started_;
+        processMetrics().recordPhase(phase_, elapsed);
+        if (operationMetrics != nullptr) {
+            operationMetrics->recordPhase(phase_, elapsed);
+        }
+    }
+
+private:
+    SafeKeeping::Phase phase_;
+    std::chrono::steady_clock::time_point started_;
+};
+
+int stepStatement(sqlite3_stmt* stmt) {
+    const PhaseTimer timer(SafeKeeping::Phase::SqliteStep);
+    return sqlite3_step(stmt);
+}
+
+// Page cache counters of one connection, added to `stats`.
+void addConnectionStatus(sqlite3* db, SafeKeeping::Stats& stats) {
+    int current = 0;
+    int highwater = 0;
+    if (sqlite3_db_status(db, SQLITE_DBSTATUS_CACHE_HIT, &current, &highwater, 0) == SQLITE_OK) {
+        stats.sqliteCacheHits += static_cast<std::uint64_t>(current);
+    }
+    if (sqlite3_db_status(db, SQLITE_DBSTATUS_CACHE_MISS, &current, &highwater, 0) == SQLITE_OK) {
+        stats.sqliteCacheMisses += static_cast<std::uint64_t>(current);
+    }
+    if (sqlite3_db_status(db, SQLITE_DBSTATUS_CACHE_USED, &current, &highwater, 0) == SQLITE_OK) {
+        stats.sqliteCacheBytes += static_cast<std::uint64_t>(current);
+    }
+}
+
 struct StatementDeleter {
     void operator()(sqlite3_stmt* stmt) const noexcept {
         if (stmt != nullptr) {
@@ -129,6 +379,7 @@ using sqlite_ptr = std::unique_ptr<sqlite3, SqliteDeleter>;
 class Transaction {
 public:
     explicit Transaction(sqlite3* db) : db_(db) {
+        const PhaseTimer timer(SafeKeeping::Phase::SqliteCommit);
         execute(db_, "BEGIN IMMEDIATE TRANSACTION");
     }
 
@@ -139,6 +390,7 @@ public:
     }
 
     void commit() {
+        const PhaseTimer timer(SafeKeeping::Phase::SqliteCommit);
         execute(db_, "COMMIT");
         committed_ = true;
     }
@@ -168,6 +420,18 @@ public:
     virtual std::optional<std::string> load(std::string_view namespaceName,
                                             std::string_view key) = 0;
     virtual bool remove(std::string_view namespaceName, std::string_view key) = 0;
+    // Loads `key` for many namespaces at once, keyed by namespace. Missing
+    // entries are left out. Backends that can search in bulk override this.
+    [[nodiscard]] virtual std::map<std::string, std::string> loadMany(std::span<const std::string> namespaceNames,
+                                                                      std::string_view key) {
+        std::map<std::string, std::string> loaded;
+        for (const auto& namespaceName : namespaceNames) {
+            if (auto value = load(namespaceName, key); value.has_value()) {
+                loaded.emplace(namespaceName, std::move(*value));
+            }
+        }
+        return loaded;
+    }
     [[nodiscard]] virtual std::string lastErrorMessage() const {
         return {};
     }
@@ -194,12 +458,8 @@ public:
     return out;
 }
 
-[[nodiscard]] std::vector<std::byte> toByteVector(const bytes& value) {
-    std::vector<std::byte> out(value.size());
-    std::transform(value.begin(), value.end(), out.begin(), [](unsigned char byte) {
-        return static_cast<std::byte>(byte);
-    });
-    return out;
+[[nodiscard]] std::span<unsigned char> asWritableUnsigned(std::span<std::byte> value) {
+    return {reinterpret_cast<unsigned char*>(value.data()), value.size()};
 }
 
 [[nodiscard]] bool envFlagEnabled(const char* name) {
@@ -227,25 +487,43 @@ void ensureSodium() {
     (void)initialized;
 }
 
-void validateNamespaceOrSecretName(std::string_view name, std::string_view label) {
-    static const std::regex validName{R"(^[A-Za-z0-9_.-]{1,128}$)"};
+// Matches [A-Za-z0-9_.-]{1,128}. Checked by hand since this runs on every
+// secret lookup.
+[[nodiscard]] bool isValidName(std::string_view name) noexcept {
+    if (name.empty() || name.size() > 128) {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(), [](char ch) {
+        return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') ||
+            ch == '_' || ch == '.' || ch == '-';
+    });
+}
+
+// Non-throwing checks for the hot path. The validate* wrappers throw.
+[[nodiscard]] std::optional<SafeKeeping::ErrorInfo> checkName(std::string_view name, std::string_view label) {
+    if (isValidName(name)) {
+        return std::nullopt;
+    }
+    return SafeKeeping::ErrorInfo{.error = SafeKeeping::Error::InvalidArgument,
+                                  .message = toString(label) + " must match [A-Za-z0-9_.-]{1,128}"};
+}
 
-    if (!std::regex_match(name.begin(), name.end(), validName)) {
-        fail(SafeKeeping::Error::InvalidArgument,
-             toString(label) + " must match [A-Za-z0-9_.-]{1,128}");
+[[nodiscard]] std::optional<SafeKeeping::ErrorInfo> checkDescription(std::string_view description) {
+    if (description.size() <= 4096) {
+        return std::nullopt;
     }
+    return SafeKeeping::ErrorInfo{.error = SafeKeeping::Error::InvalidArgument,
+                                  .message = "description is too long"};
 }
 
-void validateDescription(std::string_view description) {
-    if (description.size() > 4096) {
-        fail(SafeKeeping::Error::InvalidArgument, "description is too long");
+void validateNamespaceOrSecretName(std::string_view name, std::string_view label) {
+    if (auto error = checkName(name, label)) {
+        fail(error->error, std::move(error->message));
     }
 }
 
 void validateLinuxVaultRootName(std::string_view name) {
-    static const std::regex validName{R"(^[A-Za-z0-9_.-]{1,128}$)"};
-
-    if (!std::regex_match(name.begin(), name.end(), validName)) {
+    if (!isValidName(name)) {
         throw std::invalid_argument("linux vault root name must match [A-Za-z0-9_.-]{1,128}");
     }
 }
@@ -265,10 +543,30 @@ void validateLinuxVaultRootName(std::string_view name) {
     return linuxVaultRootStorage();
 }
 
-void validateSecretValue(byte_view secret) {
-    if (secret.size() > kMaxSecretSize) {
-        fail(SafeKeeping::Error::TooLarge, "secret exceeds 10240 bytes");
+[[nodiscard]] std::atomic<std::chrono::milliseconds::rep>& systemVaultTimeoutStorage() {
+    static std::atomic<std::chrono::milliseconds::rep> value{kDefaultSystemVaultTimeout.count()};
+    return value;
+}
+
+[[nodiscard]] std::chrono::milliseconds systemVaultTimeout() {
+    return std::chrono::milliseconds{systemVaultTimeoutStorage().load(std::memory_order_relaxed)};
+}
+
+[[nodiscard]] std::atomic<SafeKeeping::StoreLayout>& storeLayoutStorage() {
+    static std::atomic<SafeKeeping::StoreLayout> value{SafeKeeping::StoreLayout::PerNamespace};
+    return value;
+}
+
+[[nodiscard]] SafeKeeping::StoreLayout storeLayout() {
+    return storeLayoutStorage().load(std::memory_order_relaxed);
+}
+
+[[nodiscard]] std::optional<SafeKeeping::ErrorInfo> checkSecretValue(byte_view secret) {
+    if (secret.size() <= kMaxSecretSize) {
+        return std::nullopt;
     }
+    return SafeKeeping::ErrorInfo{.error = SafeKeeping::Error::TooLarge,
+                                  .message = "secret exceeds 10240 bytes"};
 }
 
 [[nodiscard]] std::filesystem::path userHomePath() {
@@ -312,9 +610,14 @@ void validateSecretValue(byte_view secret) {
     return namespacePath(namespaceName) / kDbFileName;
 }
 
+[[nodiscard]] std::filesystem::path sharedDatabasePath() {
+    return baseDataPath() / kSharedDbFileName;
+}
+
 void lockDownPath(const std::filesystem::path& path, bool directory) {
 #ifndef _WIN32
-    if (!std::filesystem::exists(path)) {
+    const auto status = std::filesystem::status(path);
+    if (!std::filesystem::exists(status)) {
         return;
     }
 
@@ -325,6 +628,10 @@ void lockDownPath(const std::filesystem::path& path, bool directory) {
         : (std::filesystem::perms::owner_read |
            std::filesystem::perms::owner_write);
 
+    // One stat when the mode is already right, as it is after the first call.
+    if ((status.permissions() & std::filesystem::perms::mask) == perms) {
+        return;
+    }
     std::filesystem::permissions(path, perms, std::filesystem::perm_options::replace);
 #else
     (void)path;
@@ -385,23 +692,99 @@ void lockDownDatabaseArtifacts(const std::filesystem::path& dbPath) {
     return randomBytes(crypto_aead_xchacha20poly1305_ietf_NPUBBYTES);
 }
 
-[[nodiscard]] bytes deriveHashKey(const bytes& dek) {
-    bytes hashKey(crypto_generichash_BYTES);
+using key_view = std::span<const unsigned char>;
+using name_hash_t = std::array<unsigned char, crypto_generichash_BYTES>;
+
+constexpr std::string_view kAadSecretName = "secret-name-v1:";
+constexpr std::string_view kAadSecretValue = "secret-value-v1:";
+constexpr std::string_view kAadSecretDescription = "secret-description-v1:";
+constexpr std::string_view kAadSecretChunk = "secret-chunk-v1:";
+constexpr std::string_view kAadAuditRecord = "audit-record-v1:";
+
+// Heap memory from sodium_malloc(): guard pages around the data, mlock()ed,
+// and wiped by sodium_free() on release.
+class GuardedBytes {
+public:
+    GuardedBytes() = default;
+
+    explicit GuardedBytes(std::size_t size) : size_(size) {
+        ensureSodium();
+        data_ = static_cast<unsigned char*>(sodium_malloc(size));
+        if (data_ == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+
+    GuardedBytes(const GuardedBytes&) = delete;
+    GuardedBytes& operator=(const GuardedBytes&) = delete;
+
+    GuardedBytes(GuardedBytes&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)) {}
+
+    GuardedBytes& operator=(GuardedBytes&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~GuardedBytes() {
+        release();
+    }
+
+    [[nodiscard]] unsigned char* data() noexcept {
+        return data_;
+    }
+
+    [[nodiscard]] const unsigned char* data() const noexcept {
+        return data_;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return data_ == nullptr;
+    }
+
+    void makeReadOnly() {
+        if (data_ != nullptr) {
+            sodium_mprotect_readonly(data_);
+        }
+    }
+
+private:
+    void release() noexcept {
+        if (data_ != nullptr) {
+            sodium_free(data_);
+            data_ = nullptr;
+            size_ = 0;
+        }
+    }
+
+    unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// A subkey of the DEK for one purpose, named by `label`.
+void deriveSubkey(key_view dek, std::string_view label, std::span<unsigned char> subkey) {
     if (crypto_generichash(
-            hashKey.data(),
-            hashKey.size(),
-            reinterpret_cast<const unsigned char*>("name-hash-v1"),
-            std::strlen("name-hash-v1"),
+            subkey.data(),
+            subkey.size(),
+            reinterpret_cast<const unsigned char*>(label.data()),
+            label.size(),
             dek.data(),
             dek.size()) != 0) {
-        throw std::runtime_error("failed to derive hash key");
+        throw std::runtime_error("failed to derive subkey");
     }
-    return hashKey;
 }
 
-[[nodiscard]] bytes computeNameHash(const bytes& dek, std::string_view name) {
-    const auto hashKey = deriveHashKey(dek);
-    bytes hash(crypto_generichash_BYTES);
+[[nodiscard]] name_hash_t computeNameHash(key_view hashKey, std::string_view name) {
+    name_hash_t hash{};
     if (crypto_generichash(
             hash.data(),
             hash.size(),
@@ -414,11 +797,354 @@ void lockDownDatabaseArtifacts(const std::filesystem::path& dbPath) {
     return hash;
 }
 
-[[nodiscard]] bytes aeadEncrypt(const bytes& plaintext,
-                                const bytes& key,
+// Key material for an unlocked namespace. Everything a secret operation needs
+// is derived once, when the DEK is installed, and kept in one read-only
+// guarded allocation:
+//
+//   [0, 32)  DEK, the AEAD key for names, values and descriptions
+//   [32, 64) name-hash key, BLAKE2b(key = DEK, "name-hash-v1")
+//   [64, 96) audit log key, BLAKE2b(key = DEK, "audit-log-v1")
+//
+// Names, values and descriptions are separated by their AAD context
+// (kAadSecretName / kAadSecretValue / kAadSecretDescription) rather than by
+// distinct keys, which keeps existing databases readable.
+class KeySchedule {
+public:
+    explicit KeySchedule(key_view dek)
+        : material_(kKeyBytes + kHashKeyBytes + kKeyBytes) {
+        if (dek.size() != kKeyBytes) {
+            throw std::runtime_error("unexpected DEK size");
+        }
+        std::memcpy(material_.data(), dek.data(), kKeyBytes);
+        deriveSubkey(dek, "name-hash-v1", {material_.data() + kKeyBytes, kHashKeyBytes});
+        deriveSubkey(dek, "audit-log-v1", {material_.data() + kKeyBytes + kHashKeyBytes, kKeyBytes});
+        material_.makeReadOnly();
+    }
+
+    [[nodiscard]] key_view dek() const noexcept {
+        return {material_.data(), kKeyBytes};
+    }
+
+    [[nodiscard]] key_view nameHashKey() const noexcept {
+        return {material_.data() + kKeyBytes, kHashKeyBytes};
+    }
+
+    [[nodiscard]] key_view auditKey() const noexcept {
+        return {material_.data() + kKeyBytes + kHashKeyBytes, kKeyBytes};
+    }
+
+    [[nodiscard]] name_hash_t nameHash(std::string_view name) const {
+        return computeNameHash(nameHashKey(), name);
+    }
+
+private:
+    static constexpr std::size_t kKeyBytes = crypto_aead_xchacha20poly1305_ietf_KEYBYTES;
+    static constexpr std::size_t kHashKeyBytes = crypto_generichash_BYTES;
+
+    GuardedBytes material_;
+};
+
+// Opt-in LRU cache of decrypted secret values, keyed by name hash.
+//
+// Values live in guarded memory and are wiped on eviction, invalidation and
+// clear(). The cache is bounded by entry count and total value bytes, and an
+// entry expires `ttl` after it was inserted. Writers call invalidate() after
+// committing. A reader passes the generation() it saw before reading the
+// database to insert(), so a value read before a concurrent write cannot be
+// cached after that write invalidated it.
+class SecretCache {
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    void configure(const SafeKeeping::CacheOptions& options) {
+        std::scoped_lock lock(mutex_);
+        options_ = options;
+        enabled_ = options.maxEntries > 0 && options.maxBytes > 0;
+        evictUntilWithinLimits();
+        if (!enabled_) {
+            clearLocked();
+        }
+    }
+
+    void disable() {
+        std::scoped_lock lock(mutex_);
+        enabled_ = false;
+        clearLocked();
+    }
+
+    [[nodiscard]] bool enabled() const {
+        std::scoped_lock lock(mutex_);
+        return enabled_;
+    }
+
+    [[nodiscard]] std::uint64_t generation() const {
+        std::scoped_lock lock(mutex_);
+        return generation_;
+    }
+
+    // Copy a cached value into the buffer `allocate(size)` returns. Empty on
+    // a miss; otherwise the size copied, or the error from `allocate`.
+    template <typename Allocate>
+    [[nodiscard]] std::optional<SafeKeeping::result_t<std::size_t>> lookup(const name_hash_t& nameHash,
+                                                                           Allocate&& allocate) {
+        std::scoped_lock lock(mutex_);
+        if (!enabled_) {
+            return std::nullopt;
+        }
+        const auto it = index_.find(nameHash);
+        if (it == index_.end()) {
+            ++misses_;
+            return std::nullopt;
+        }
+        if (clock_t::now() >= it->second->expires) {
+            ++expirations_;
+            ++misses_;
+            erase(it->second);
+            return std::nullopt;
+        }
+        ++hits_;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        const auto size = it->second->size;
+        auto target = std::forward<Allocate>(allocate)(size);
+        if (!target) {
+            return Unexpected(std::move(target).error());
+        }
+        if (size > 0) {
+            std::memcpy(target->data(), it->second->value.data(), size);
+        }
+        return size;
+    }
+
+    void insert(const name_hash_t& nameHash, byte_view value, std::uint64_t seenGeneration) {
+        std::scoped_lock lock(mutex_);
+        if (!enabled_ || seenGeneration != generation_ || value.size() > options_.maxBytes) {
+            return;
+        }
+        if (const auto it = index_.find(nameHash); it != index_.end()) {
+            erase(it->second);
+        }
+
+        Entry entry;
+        entry.nameHash = nameHash;
+        // sodium_malloc(0) is valid, but keep one byte so data() is never null.
+        entry.value = GuardedBytes(std::max<std::size_t>(value.size(), 1));
+        entry.size = value.size();
+        if (!value.empty()) {
+            std::memcpy(entry.value.data(), value.data(), value.size());
+        }
+        entry.expires = clock_t::now() + options_.ttl;
+        entries_.push_front(std::move(entry));
+        index_[nameHash] = entries_.begin();
+        bytes_ += value.size();
+        evictUntilWithinLimits();
+    }
+
+    void invalidate(std::span<const unsigned char> nameHash) {
+        std::scoped_lock lock(mutex_);
+        ++generation_;
+        if (nameHash.size() != std::tuple_size_v<name_hash_t>) {
+            return;
+        }
+        name_hash_t key{};
+        std::copy(nameHash.begin(), nameHash.end(), key.begin());
+        if (const auto it = index_.find(key); it != index_.end()) {
+            erase(it->second);
+        }
+    }
+
+    void clear() {
+        std::scoped_lock lock(mutex_);
+        clearLocked();
+    }
+
+    [[nodiscard]] SafeKeeping::CacheStats stats() const {
+        std::scoped_lock lock(mutex_);
+        return {
+            .hits = hits_,
+            .misses = misses_,
+            .evictions = evictions_,
+            .expirations = expirations_,
+            .entries = entries_.size(),
+            .bytes = bytes_,
+        };
+    }
+
+private:
+    struct Entry {
+        name_hash_t nameHash{};
+        GuardedBytes value;
+        std::size_t size = 0;
+        clock_t::time_point expires;
+    };
+
+    using entry_list_t = std::list<Entry>;
+
+    void erase(entry_list_t::iterator it) {
+        bytes_ -= it->size;
+        index_.erase(it->nameHash);
+        entries_.erase(it);
+    }
+
+    void evictUntilWithinLimits() {
+        while (!entries_.empty() &&
+               (entries_.size() > options_.maxEntries || bytes_ > options_.maxBytes)) {
+            ++evictions_;
+            erase(std::prev(entries_.end()));
+        }
+    }
+
+    void clearLocked() {
+        ++generation_;
+        index_.clear();
+        entries_.clear();
+        bytes_ = 0;
+    }
+
+    mutable std::mutex mutex_;
+    SafeKeeping::CacheOptions options_;
+    bool enabled_ = false;
+    std::uint64_t generation_ = 0;
+    entry_list_t entries_;
+    std::map<name_hash_t, entry_list_t::iterator> index_;
+    std::size_t bytes_ = 0;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+    std::uint64_t evictions_ = 0;
+    std::uint64_t expirations_ = 0;
+};
+
+// AAD for per-secret ciphertexts, "<context><hex(name hash)>", built in a
+// fixed buffer so encrypting or decrypting a record does not allocate.
+class SecretAad {
+public:
+    SecretAad(std::string_view context, std::span<const unsigned char> nameHash) {
+        if (nameHash.size() != crypto_generichash_BYTES) {
+            fail(SafeKeeping::Error::DataCorrupted, "secret name hash has an unexpected size");
+        }
+        std::memcpy(buffer_.data(), context.data(), context.size());
+        sodium_bin2hex(buffer_.data() + context.size(),
+                       buffer_.size() - context.size(),
+                       nameHash.data(),
+                       nameHash.size());
+        size_ = context.size() + (nameHash.size() * 2);
+    }
+
+    [[nodiscard]] std::string_view view() const noexcept {
+        return {buffer_.data(), size_};
+    }
+
+private:
+    static constexpr std::size_t kMaxContext = 32;
+    static_assert(kAadSecretName.size() <= kMaxContext);
+    static_assert(kAadSecretValue.size() <= kMaxContext);
+    static_assert(kAadSecretDescription.size() <= kMaxContext);
+
+    std::array<char, kMaxContext + (crypto_generichash_BYTES * 2) + 1> buffer_{};
+    std::size_t size_ = 0;
+};
+
+// Describes a streamed secret. Stored, encrypted, in place of the value of
+// its secrets row; the chunks themselves live in secret_chunks.
+//
+// Each chunk is sealed with its own nonce, and its AAD binds the stream id,
+// the chunk index and whether it is the last chunk. Together with the chunk
+// count and total size here, that rejects reordered, swapped or truncated
+// chunks while still letting any one chunk be decrypted on its own.
+struct StreamManifest {
+    static constexpr unsigned char kVersion = 1;
+    static constexpr std::size_t kEncodedSize = 1 + kStreamIdBytes + 4 + 8 + 8;
+
+    std::array<unsigned char, kStreamIdBytes> streamId{};
+    std::uint32_t chunkSize = 0;
+    std::uint64_t totalSize = 0;
+    std::uint64_t chunkCount = 0;
+
+    [[nodiscard]] bytes encode() const {
+        bytes out;
+        out.reserve(kEncodedSize);
+        out.push_back(kVersion);
+        out.insert(out.end(), streamId.begin(), streamId.end());
+        appendLittleEndian(out, chunkSize, 4);
+        appendLittleEndian(out, totalSize, 8);
+        appendLittleEndian(out, chunkCount, 8);
+        return out;
+    }
+
+    [[nodiscard]] static StreamManifest decode(std::span<const std::byte> encoded) {
+        if (encoded.size() != kEncodedSize || static_cast<unsigned char>(encoded[0]) != kVersion) {
+            fail(SafeKeeping::Error::DataCorrupted, "secret stream manifest is corrupted");
+        }
+        const auto* data = reinterpret_cast<const unsigned char*>(encoded.data()) + 1;
+        StreamManifest manifest;
+        std::memcpy(manifest.streamId.data(), data, kStreamIdBytes);
+        data += kStreamIdBytes;
+        manifest.chunkSize = static_cast<std::uint32_t>(readLittleEndian(data, 4));
+        manifest.totalSize = readLittleEndian(data + 4, 8);
+        manifest.chunkCount = readLittleEndian(data + 12, 8);
+        if (!manifest.consistent()) {
+            fail(SafeKeeping::Error::DataCorrupted, "secret stream manifest is inconsistent");
+        }
+        return manifest;
+    }
+
+    // Plaintext size of chunk `index`.
+    [[nodiscard]] std::size_t chunkLength(std::uint64_t index) const noexcept {
+        return index + 1 < chunkCount
+            ? chunkSize
+            : static_cast<std::size_t>(totalSize - ((chunkCount - 1) * chunkSize));
+    }
+
+private:
+    // Every chunk but the last is full, and only an empty stream has an
+    // empty last chunk.
+    [[nodiscard]] bool consistent() const noexcept {
+        if (chunkSize == 0 || chunkCount == 0 ||
+            chunkCount > std::numeric_limits<std::uint64_t>::max() / chunkSize) {
+            return false;
+        }
+        const std::uint64_t full = (chunkCount - 1) * chunkSize;
+        return totalSize <= full + chunkSize && (chunkCount == 1 || totalSize > full);
+    }
+
+    static void appendLittleEndian(bytes& out, std::uint64_t value, std::size_t width) {
+        for (std::size_t i = 0; i < width; ++i) {
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    [[nodiscard]] static std::uint64_t readLittleEndian(const unsigned char* data, std::size_t width) {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < width; ++i) {
+            value |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+};
+
+// A decrypted secrets row: the value itself, or the manifest of a streamed
+// value.
+struct StoredValue {
+    std::vector<std::byte> value;
+    std::optional<StreamManifest> manifest;
+};
+
+[[nodiscard]] std::string chunkAad(std::span<const unsigned char> streamId, std::uint64_t index, bool last) {
+    std::string aad(kAadSecretChunk);
+    aad += bytesToHex(streamId);
+    aad += ':';
+    aad += std::to_string(index);
+    if (last) {
+        aad += ":last";
+    }
+    return aad;
+}
+
+[[nodiscard]] bytes aeadEncrypt(std::span<const unsigned char> plaintext,
+                                key_view key,
                                 std::string_view ad,
                                 bytes& nonceOut) {
     ensureSodium();
+    const PhaseTimer timer(SafeKeeping::Phase::Aead);
     nonceOut = makeNonce();
     bytes ciphertext(plaintext.size() + crypto_aead_xchacha20poly1305_ietf_ABYTES);
     unsigned long long ciphertextLen = 0;
@@ -438,16 +1164,29 @@ void lockDownDatabaseArtifacts(const std::filesystem::path& dbPath) {
     return ciphertext;
 }
 
-[[nodiscard]] bytes aeadDecrypt(const bytes& ciphertext,
-                                const bytes& nonce,
-                                const bytes& key,
-                                std::string_view ad) {
+// Plaintext size of an AEAD ciphertext, known before decrypting it.
+[[nodiscard]] std::size_t openedSize(std::span<const unsigned char> ciphertext) {
+    if (ciphertext.size() < crypto_aead_xchacha20poly1305_ietf_ABYTES) {
+        throw std::runtime_error("ciphertext authentication failed");
+    }
+    return ciphertext.size() - crypto_aead_xchacha20poly1305_ietf_ABYTES;
+}
+
+// Decrypt straight into `out`, which must be exactly openedSize(ciphertext)
+// bytes. libsodium verifies the tag before writing any plaintext.
+void aeadDecryptInto(std::span<const unsigned char> ciphertext,
+                     std::span<const unsigned char> nonce,
+                     key_view key,
+                     std::string_view ad,
+                     std::span<unsigned char> out) {
     ensureSodium();
-    bytes plaintext(ciphertext.size());
-    unsigned long long plaintextLen = 0;
+    if (nonce.size() != crypto_aead_xchacha20poly1305_ietf_NPUBBYTES || out.size() != openedSize(ciphertext)) {
+        throw std::runtime_error("ciphertext authentication failed");
+    }
+    const PhaseTimer timer(SafeKeeping::Phase::Aead);
     if (crypto_aead_xchacha20poly1305_ietf_decrypt(
-            plaintext.data(),
-            &plaintextLen,
+            out.data(),
+            nullptr,
             nullptr,
             ciphertext.data(),
             ciphertext.size(),
@@ -457,7 +1196,14 @@ void lockDownDatabaseArtifacts(const std::filesystem::path& dbPath) {
             key.data()) != 0) {
         throw std::runtime_error("ciphertext authentication failed");
     }
-    plaintext.resize(static_cast<std::size_t>(plaintextLen));
+}
+
+[[nodiscard]] bytes aeadDecrypt(const bytes& ciphertext,
+                                const bytes& nonce,
+                                key_view key,
+                                std::string_view ad) {
+    bytes plaintext(openedSize(ciphertext));
+    aeadDecryptInto(ciphertext, nonce, key, ad, plaintext);
     return plaintext;
 }
 
@@ -467,6 +1213,7 @@ void lockDownDatabaseArtifacts(const std::filesystem::path& dbPath) {
                                         std::size_t memlimit) {
     ensureSodium();
     bytes key(crypto_aead_xchacha20poly1305_ietf_KEYBYTES);
+    const PhaseTimer timer(SafeKeeping::Phase::Kdf);
     if (crypto_pwhash(
             key.data(),
             key.size(),
@@ -481,6 +1228,95 @@ void lockDownDatabaseArtifacts(const std::filesystem::path& dbPath) {
     return key;
 }
 
+// Argon2id limits of a passphrase or recovery key slot.
+struct KdfParams {
+    unsigned long long opslimit = crypto_pwhash_OPSLIMIT_INTERACTIVE;
+    std::size_t memlimit = crypto_pwhash_MEMLIMIT_INTERACTIVE;
+};
+
+// The operation count at interactive memory that takes about `target` on
+// this machine, but at least the interactive count. Argon2 time grows
+// linearly with the operation count, so one timed derivation is enough.
+[[nodiscard]] KdfParams calibrateKdf(std::chrono::milliseconds target) {
+    static std::mutex mutex;
+    static std::map<std::chrono::milliseconds::rep, KdfParams> calibrated;
+    const std::scoped_lock lock(mutex);
+    if (const auto it = calibrated.find(target.count()); it != calibrated.end()) {
+        return it->second;
+    }
+
+    KdfParams params;
+    const bytes salt(crypto_pwhash_SALTBYTES, 0);
+    const auto start = std::chrono::steady_clock::now();
+    auto probe = derivePassphraseKek("calibration", salt, params.opslimit, params.memlimit);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    sodium_memzero(probe.data(), probe.size());
+
+    if (elapsed.count() > 0) {
+        const auto perOperation = elapsed.count() / static_cast<double>(params.opslimit);
+        const auto operations = std::chrono::duration<double>(target).count() / perOperation;
+        params.opslimit = static_cast<unsigned long long>(
+            std::clamp(operations,
+                       static_cast<double>(crypto_pwhash_OPSLIMIT_INTERACTIVE),
+                       static_cast<double>(std::numeric_limits<std::uint32_t>::max())));
+    }
+    calibrated.emplace(target.count(), params);
+    return params;
+}
+
+[[nodiscard]] KdfParams kdfParams(const std::optional<SafeKeeping::KdfOptions>& options) {
+    if (!options.has_value()) {
+        return {};
+    }
+    switch (options->profile) {
+    case SafeKeeping::KdfProfile::Interactive:
+        return {};
+    case SafeKeeping::KdfProfile::Moderate:
+        return {.opslimit = crypto_pwhash_OPSLIMIT_MODERATE, .memlimit = crypto_pwhash_MEMLIMIT_MODERATE};
+    case SafeKeeping::KdfProfile::Sensitive:
+        return {.opslimit = crypto_pwhash_OPSLIMIT_SENSITIVE, .memlimit = crypto_pwhash_MEMLIMIT_SENSITIVE};
+    case SafeKeeping::KdfProfile::Minimal:
+        return {.opslimit = crypto_pwhash_OPSLIMIT_MIN, .memlimit = crypto_pwhash_MEMLIMIT_MIN};
+    case SafeKeeping::KdfProfile::Calibrated:
+        return calibrateKdf(options->targetLatency);
+    }
+    return {};
+}
+
+// A new KDF-protected slot's salt, with its KEK being derived on the KDF
+// executor so several derivations, or a derivation and a vault round trip,
+// overlap. The KEK is wiped on destruction, whether or not it was used.
+struct PendingKek {
+    PendingKek() = default;
+    PendingKek(PendingKek&&) noexcept = default;
+    PendingKek& operator=(PendingKek&&) noexcept = default;
+    PendingKek(const PendingKek&) = delete;
+    PendingKek& operator=(const PendingKek&) = delete;
+
+    ~PendingKek() {
+        if (derivation.valid()) {
+            try {
+                kek = derivation.get();
+            } catch (const std::exception&) {
+                // Nothing was derived, so nothing to wipe.
+            }
+        }
+        sodium_memzero(kek.data(), kek.size());
+    }
+
+    // Waits for the derivation on first use.
+    [[nodiscard]] const bytes& get() {
+        if (derivation.valid()) {
+            kek = derivation.get();
+        }
+        return kek;
+    }
+
+    bytes salt;
+    std::future<bytes> derivation;
+    bytes kek;
+};
+
 [[nodiscard]] bytes deriveVaultKek(std::string_view vaultMaterial) {
     ensureSodium();
     bytes key(crypto_aead_xchacha20poly1305_ietf_KEYBYTES);
@@ -533,7 +1369,7 @@ statement_ptr prepare(sqlite3* db, std::string_view sql) {
     return statement_ptr(stmt);
 }
 
-void bindBlob(sqlite3_stmt* stmt, int index, const bytes& value) {
+void bindBlob(sqlite3_stmt* stmt, int index, std::span<const unsigned char> value) {
     if (sqlite3_bind_blob(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT) != SQLITE_OK) {
         throw std::runtime_error("failed to bind blob");
     }
@@ -572,7 +1408,7 @@ void bindInt64(sqlite3_stmt* stmt, int index, std::int64_t value) {
 }
 
 void stepDone(sqlite3* db, sqlite3_stmt* stmt) {
-    if (sqlite3_step(stmt) != SQLITE_DONE) {
+    if (stepStatement(stmt) != SQLITE_DONE) {
         throw std::runtime_error(sqlite3_errmsg(db));
     }
 }
@@ -586,6 +1422,17 @@ void stepDone(sqlite3* db, sqlite3_stmt* stmt) {
     return bytes(data, data + size);
 }
 
+// A blob column without copying it. The view is valid until the statement
+// is stepped or reset.
+[[nodiscard]] std::span<const unsigned char> columnView(sqlite3_stmt* stmt, int index) {
+    const auto* data = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, index));
+    const int size = sqlite3_column_bytes(stmt, index);
+    if (data == nullptr || size <= 0) {
+        return {};
+    }
+    return {data, static_cast<std::size_t>(size)};
+}
+
 [[nodiscard]] std::optional<bytes> columnOptionalBlob(sqlite3_stmt* stmt, int index) {
     if (sqlite3_column_type(stmt, index) == SQLITE_NULL) {
         return std::nullopt;
@@ -611,6 +1458,392 @@ void execute(sqlite3* db, std::string_view sql) {
     }
 }
 
+// Number of IN-list placeholders in StatementId::SelectSecretsBatch.
+constexpr std::size_t kLookupBatchSize = 64;
+// Rows read from SQLite before a listing scan decrypts and emits them.
+constexpr std::size_t kScanChunkRows = 512;
+
+enum class StatementId : std::size_t {
+    ReadSingleSlot,
+    ActiveSlotCount,
+    HasSlot,
+    InsertSlot,
+    RemoveActiveSlot,
+    UpsertSecret,
+    SelectSecret,
+    SelectSecretsBatch,
+    DeleteSecret,
+    ListSecrets,
+    UpdateMetadataTimestamp,
+    DeleteSecretChunks,
+    DeleteStreamChunks,
+    InsertChunk,
+    SelectChunk,
+    NamespaceExists,
+    Count,
+};
+
+constexpr std::array<std::string_view, static_cast<std::size_t>(StatementId::Count)> kStatementSql = {
+    "SELECT slot_id, slot_type, kdf_name, kdf_salt, kdf_opslimit, kdf_memlimit, nonce, wrapped_dek "
+    "FROM key_slots WHERE status = 'active' AND slot_type = ? LIMIT 1",
+
+    "SELECT COUNT(*) FROM key_slots WHERE status = 'active'",
+
+    "SELECT 1 FROM key_slots WHERE status = 'active' AND slot_type = ? LIMIT 1",
+
+    "INSERT INTO key_slots (slot_id, slot_type, status, kdf_name, kdf_salt, kdf_opslimit, "
+    "kdf_memlimit, nonce, wrapped_dek, created_at, updated_at, label) "
+    "VALUES (?, ?, 'active', ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+
+    "DELETE FROM key_slots WHERE status = 'active' AND slot_type = ?",
+
+    "INSERT INTO secrets (name_hash, name_nonce, name_ciphertext, value_nonce, value_ciphertext, "
+    "description_nonce, description_ciphertext, created_at, updated_at, stream_id) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+    "ON CONFLICT(name_hash) DO UPDATE SET "
+    "name_nonce = excluded.name_nonce, "
+    "name_ciphertext = excluded.name_ciphertext, "
+    "value_nonce = excluded.value_nonce, "
+    "value_ciphertext = excluded.value_ciphertext, "
+    "description_nonce = excluded.description_nonce, "
+    "description_ciphertext = excluded.description_ciphertext, "
+    "updated_at = excluded.updated_at, "
+    "stream_id = excluded.stream_id",
+
+    "SELECT name_nonce, name_ciphertext, value_nonce, value_ciphertext, stream_id "
+    "FROM secrets WHERE name_hash = ?",
+
+    "SELECT name_hash, name_nonce, name_ciphertext, value_nonce, value_ciphertext, stream_id "
+    "FROM secrets WHERE name_hash IN ("
+    "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
+    "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
+    "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
+    "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+
+    "DELETE FROM secrets WHERE name_hash = ?",
+
+    "SELECT name_hash, name_nonce, name_ciphertext, description_nonce, description_ciphertext "
+    "FROM secrets WHERE name_hash > ? ORDER BY name_hash LIMIT ?",
+
+    "UPDATE metadata SET updated_at = ?",
+
+    "DELETE FROM secret_chunks WHERE stream_id = (SELECT stream_id FROM secrets WHERE name_hash = ?)",
+
+    "DELETE FROM secret_chunks WHERE stream_id = ?",
+
+    "INSERT INTO secret_chunks (stream_id, chunk_index, nonce, ciphertext) VALUES (?, ?, ?, ?)",
+
+    "SELECT nonce, ciphertext FROM secret_chunks WHERE stream_id = ? AND chunk_index = ?",
+
+    "SELECT 1 FROM metadata WHERE namespace_name = ?",
+};
+
+// kStatementSql for the shared store. Parameters are numbered as above, and
+// the namespace id is always the last one; StatementCache binds it.
+constexpr std::array<std::string_view, static_cast<std::size_t>(StatementId::Count)> kSharedStatementSql = {
+    "SELECT slot_id, slot_type, kdf_name, kdf_salt, kdf_opslimit, kdf_memlimit, nonce, wrapped_dek "
+    "FROM key_slots WHERE status = 'active' AND slot_type = ? AND namespace_id = ? LIMIT 1",
+
+    "SELECT COUNT(*) FROM key_slots WHERE status = 'active' AND namespace_id = ?",
+
+    "SELECT 1 FROM key_slots WHERE status = 'active' AND slot_type = ? AND namespace_id = ? LIMIT 1",
+
+    "INSERT INTO key_slots (slot_id, slot_type, status, kdf_name, kdf_salt, kdf_opslimit, "
+    "kdf_memlimit, nonce, wrapped_dek, created_at, updated_at, label, namespace_id) "
+    "VALUES (?, ?, 'active', ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+
+    "DELETE FROM key_slots WHERE status = 'active' AND slot_type = ? AND namespace_id = ?",
+
+    "INSERT INTO secrets (name_hash, name_nonce, name_ciphertext, value_nonce, value_ciphertext, "
+    "description_nonce, description_ciphertext, created_at, updated_at, stream_id, namespace_id) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+    "ON CONFLICT(namespace_id, name_hash) DO UPDATE SET "
+    "name_nonce = excluded.name_nonce, "
+    "name_ciphertext = excluded.name_ciphertext, "
+    "value_nonce = excluded.value_nonce, "
+    "value_ciphertext = excluded.value_ciphertext, "
+    "description_nonce = excluded.description_nonce, "
+    "description_ciphertext = excluded.description_ciphertext, "
+    "updated_at = excluded.updated_at, "
+    "stream_id = excluded.stream_id",
+
+    "SELECT name_nonce, name_ciphertext, value_nonce, value_ciphertext, stream_id "
+    "FROM secrets WHERE name_hash = ? AND namespace_id = ?",
+
+    "SELECT name_hash, name_nonce, name_ciphertext, value_nonce, value_ciphertext, stream_id "
+    "FROM secrets WHERE name_hash IN ("
+    "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
+    "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
+    "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
+    "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) AND namespace_id = ?",
+
+    "DELETE FROM secrets WHERE name_hash = ? AND namespace_id = ?",
+
+    "SELECT name_hash, name_nonce, name_ciphertext, description_nonce, description_ciphertext "
+    "FROM secrets WHERE namespace_id = ?3 AND name_hash > ?1 ORDER BY name_hash LIMIT ?2",
+
+    "UPDATE metadata SET updated_at = ? WHERE namespace_id = ?",
+
+    "DELETE FROM secret_chunks WHERE namespace_id = ?2 AND stream_id = "
+    "(SELECT stream_id FROM secrets WHERE namespace_id = ?2 AND name_hash = ?1)",
+
+    "DELETE FROM secret_chunks WHERE stream_id = ? AND namespace_id = ?",
+
+    "INSERT INTO secret_chunks (stream_id, chunk_index, nonce, ciphertext, namespace_id) VALUES (?, ?, ?, ?, ?)",
+
+    "SELECT nonce, ciphertext FROM secret_chunks WHERE stream_id = ? AND chunk_index = ? AND namespace_id = ?",
+
+    "SELECT 1 FROM metadata WHERE namespace_name = ? AND namespace_id = ?",
+};
+
+// Compiled statements for one connection, keyed by StatementId.
+//
+// acquire() hands out a lease; when the lease goes away the statement is reset
+// and its bindings cleared so no blob or read transaction outlives the call.
+// A statement that is already leased (nested use) is served by a one-off
+// prepare instead of being shared. A cache for the shared store uses
+// kSharedStatementSql and binds the namespace id on every acquire.
+class StatementCache {
+public:
+    class Lease {
+    public:
+        Lease(sqlite3_stmt* cached, bool* inUse) noexcept
+            : stmt_(cached), inUse_(inUse) {}
+        explicit Lease(statement_ptr owned) noexcept
+            : stmt_(owned.get()), owned_(std::move(owned)) {}
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ~Lease() {
+            if (inUse_ != nullptr) {
+                sqlite3_reset(stmt_);
+                sqlite3_clear_bindings(stmt_);
+                *inUse_ = false;
+            }
+        }
+
+        [[nodiscard]] sqlite3_stmt* get() const noexcept {
+            return stmt_;
+        }
+
+    private:
+        sqlite3_stmt* stmt_ = nullptr;
+        bool* inUse_ = nullptr;
+        statement_ptr owned_;
+    };
+
+    explicit StatementCache(sqlite3* db, std::optional<std::int64_t> namespaceId = std::nullopt)
+        : db_(db), namespaceId_(namespaceId) {}
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    [[nodiscard]] sqlite3* db() const noexcept {
+        return db_;
+    }
+
+    // For pooled connections to the shared store, which serve many namespaces.
+    void setNamespaceId(std::optional<std::int64_t> namespaceId) noexcept {
+        namespaceId_ = namespaceId;
+    }
+
+    // Serve statements from another connection. Finalizes the cached ones,
+    // so the same rule as for clear() applies.
+    void attach(sqlite3* db) noexcept {
+        clear();
+        db_ = db;
+    }
+
+    [[nodiscard]] Lease acquire(StatementId id) {
+        const auto index = static_cast<std::size_t>(id);
+        const auto sql = namespaceId_.has_value() ? kSharedStatementSql[index] : kStatementSql[index];
+        auto& entry = entries_[index];
+        if (entry.inUse) {
+            auto stmt = prepare(db_, sql);
+            bindNamespace(stmt.get());
+            return Lease(std::move(stmt));
+        }
+        if (!entry.stmt) {
+            entry.stmt = prepare(db_, sql);
+        }
+        bindNamespace(entry.stmt.get());
+        entry.inUse = true;
+        return Lease(entry.stmt.get(), &entry.inUse);
+    }
+
+    // Finalize every cached statement. Must not be called while a lease is live.
+    void clear() noexcept {
+        for (auto& entry : entries_) {
+            entry.stmt.reset();
+            entry.inUse = false;
+        }
+    }
+
+private:
+    struct Entry {
+        statement_ptr stmt;
+        bool inUse = false;
+    };
+
+    void bindNamespace(sqlite3_stmt* stmt) const {
+        if (namespaceId_.has_value()) {
+            bindInt64(stmt, sqlite3_bind_parameter_count(stmt), *namespaceId_);
+        }
+    }
+
+    sqlite3* db_;
+    std::optional<std::int64_t> namespaceId_;
+    std::array<Entry, static_cast<std::size_t>(StatementId::Count)> entries_;
+};
+
+// Fixed-size pool of worker threads.
+//
+// parallelFor() spreads index-addressed work over the workers and the calling
+// thread and returns once every index is done, rethrowing the first failure.
+class WorkerPool {
+public:
+    explicit WorkerPool(std::size_t threads) {
+        threads_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this] {
+                run();
+            });
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool() {
+        {
+            std::scoped_lock lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return threads_.size();
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::scoped_lock lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        wake_.notify_one();
+    }
+
+    template <typename Fn>
+    void parallelFor(std::size_t count, Fn&& fn) {
+        if (count == 0) {
+            return;
+        }
+
+        struct Shared {
+            std::atomic<std::size_t> next{0};
+            std::mutex mutex;
+            std::condition_variable done;
+            std::size_t activeHelpers = 0;
+            std::exception_ptr error;
+        } shared;
+
+        auto work = [&shared, &fn, count] {
+            for (auto i = shared.next.fetch_add(1); i < count; i = shared.next.fetch_add(1)) {
+                try {
+                    fn(i);
+                } catch (...) {
+                    std::scoped_lock lock(shared.mutex);
+                    if (!shared.error) {
+                        shared.error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        const auto helpers = std::min(threads_.size(), count - 1);
+        shared.activeHelpers = helpers;
+        for (std::size_t i = 0; i < helpers; ++i) {
+            submit([&shared, &work] {
+                work();
+                std::scoped_lock lock(shared.mutex);
+                if (--shared.activeHelpers == 0) {
+                    shared.done.notify_one();
+                }
+            });
+        }
+
+        work();
+
+        std::unique_lock lock(shared.mutex);
+        shared.done.wait(lock, [&shared] {
+            return shared.activeHelpers == 0;
+        });
+        if (shared.error) {
+            std::rethrow_exception(shared.error);
+        }
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [this] {
+                    return stopping_ || !tasks_.empty();
+                });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+};
+
+// Executor for unlock methods, slot rewraps and the KEKs of new slots. Small
+// on purpose: each passphrase or recovery key derivation uses about 64 MiB.
+WorkerPool& kdfExecutor() {
+    static WorkerPool pool(2);
+    return pool;
+}
+
+// Run a move-only task on the KDF executor.
+template <typename Fn>
+void runKdfTask(Fn&& fn) {
+    auto task = std::make_shared<std::decay_t<Fn>>(std::forward<Fn>(fn));
+    kdfExecutor().submit([task] {
+        (*task)();
+    });
+}
+
+[[nodiscard]] PendingKek derivePassphraseKekAsync(std::string secret, const KdfParams& params) {
+    PendingKek pending;
+    pending.salt = randomBytes(crypto_pwhash_SALTBYTES);
+    std::packaged_task<bytes()> derivation([secret = std::move(secret), salt = pending.salt, params]() mutable {
+        auto kek = derivePassphraseKek(secret, salt, params.opslimit, params.memlimit);
+        sodium_memzero(secret.data(), secret.size());
+        return kek;
+    });
+    pending.derivation = derivation.get_future();
+    runKdfTask(std::move(derivation));
+    return pending;
+}
+
+
 class FileVaultBackend final : public VaultBackend {
 public:
     explicit FileVaultBackend(std::filesystem::path root) : root_(std::move(root)) {}
@@ -661,6 +1894,125 @@ private:
 };
 
 #if defined(__linux__) || defined(__unix__)
+// One Secret Service proxy per process. Calls use the asynchronous libsecret
+// API on a private main context, so they neither depend on nor disturb the
+// application's main loop, and are cancelled when they exceed
+// systemVaultTimeout(). Calls are serialized; the proxy is created by the
+// first call that succeeds in reaching the service.
+class SecretServiceConnection {
+public:
+    static SecretServiceConnection& instance() {
+        static SecretServiceConnection connection;
+        return connection;
+    }
+
+    SecretServiceConnection(const SecretServiceConnection&) = delete;
+    SecretServiceConnection& operator=(const SecretServiceConnection&) = delete;
+
+    // `start(service, cancellable, callback, userData)` begins the call and
+    // `finish(service, result, error)` collects it. Returns false with a
+    // message in `error` if the service is unreachable, the call fails or
+    // the deadline passes.
+    template <typename Start, typename Finish>
+    bool run(std::string& error, Start&& start, Finish&& finish) {
+        const auto timeout = systemVaultTimeout();
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        const std::scoped_lock lock(mutex_);
+        g_main_context_push_thread_default(context_);
+        bool ok = false;
+        if (service_ == nullptr) {
+            connect(deadline, error);
+        }
+        if (service_ != nullptr) {
+            auto [result, cancelled] = await(
+                deadline, [this, &start](GCancellable* cancellable, GAsyncReadyCallback callback, gpointer userData) {
+                    start(service_, cancellable, callback, userData);
+                });
+            ok = finish(service_, result, error);
+            g_object_unref(result);
+            if (!ok && cancelled) {
+                error = timeoutMessage(timeout);
+            }
+        }
+        g_main_context_pop_thread_default(context_);
+        return ok;
+    }
+
+private:
+    SecretServiceConnection() : context_(g_main_context_new()) {}
+
+    ~SecretServiceConnection() {
+        if (service_ != nullptr) {
+            g_object_unref(service_);
+        }
+        g_main_context_unref(context_);
+    }
+
+    struct Pending {
+        GAsyncResult* result = nullptr;
+    };
+
+    static void onReady(GObject*, GAsyncResult* result, gpointer userData) {
+        static_cast<Pending*>(userData)->result = static_cast<GAsyncResult*>(g_object_ref(result));
+    }
+
+    static gboolean onDeadline(gpointer cancellable) {
+        g_cancellable_cancel(static_cast<GCancellable*>(cancellable));
+        return FALSE;
+    }
+
+    static std::string timeoutMessage(std::chrono::milliseconds timeout) {
+        return "secret service did not respond within " + std::to_string(timeout.count()) + " ms";
+    }
+
+    void connect(std::chrono::steady_clock::time_point deadline, std::string& error) {
+        auto [result, cancelled] = await(deadline, [](GCancellable* cancellable,
+                                                      GAsyncReadyCallback callback,
+                                                      gpointer userData) {
+            secret_service_get(SECRET_SERVICE_OPEN_SESSION, cancellable, callback, userData);
+        });
+        GError* failure = nullptr;
+        service_ = secret_service_get_finish(result, &failure);
+        g_object_unref(result);
+        if (service_ != nullptr) {
+            processMetrics().recordVaultConnection();
+        }
+        if (failure != nullptr) {
+            error = cancelled ? timeoutMessage(systemVaultTimeout()) : std::string(failure->message);
+            g_error_free(failure);
+        }
+    }
+
+    // Starts a call and iterates the private context until it completes.
+    // Past the deadline the call is cancelled; its result is still awaited,
+    // so no callback can outlive this frame. Returns the result and whether
+    // the deadline was hit.
+    template <typename Start>
+    std::pair<GAsyncResult*, bool> await(std::chrono::steady_clock::time_point deadline, Start&& start) {
+        using namespace std::chrono;
+        const auto remaining = std::max<milliseconds::rep>(
+            0, duration_cast<milliseconds>(deadline - steady_clock::now()).count());
+        Pending pending;
+        GCancellable* cancellable = g_cancellable_new();
+        GSource* timer = g_timeout_source_new(static_cast<guint>(remaining));
+        g_source_set_callback(timer, &SecretServiceConnection::onDeadline, cancellable, nullptr);
+        g_source_attach(timer, context_);
+        start(cancellable, &SecretServiceConnection::onReady, &pending);
+        while (pending.result == nullptr) {
+            g_main_context_iteration(context_, TRUE);
+        }
+        g_source_destroy(timer);
+        g_source_unref(timer);
+        const bool cancelled = g_cancellable_is_cancelled(cancellable) != FALSE;
+        g_object_unref(cancellable);
+        return {pending.result, cancelled};
+    }
+
+    std::mutex mutex_;
+    GMainContext* context_;
+    SecretService* service_ = nullptr;
+};
+
 class LibSecretVaultBackend final : public VaultBackend {
 public:
     bool available() const override {
@@ -671,77 +2023,182 @@ public:
         if (envFlagEnabled("SAFEKEEPING_DISABLE_SYSTEM_VAULT")) {
             return false;
         }
-        const std::string account = accountName(namespaceName, key);
-        const std::string service = serviceName(namespaceName);
-        GError* error = nullptr;
-        const gboolean ok = secret_password_store_sync(
-            &schema(),
-            SECRET_COLLECTION_DEFAULT,
-            displayLabel(namespaceName, key).c_str(),
-            value.data(),
-            nullptr,
-            &error,
-            "service", service.c_str(),
-            "account", account.c_str(),
-            nullptr);
-        if (error != nullptr) {
-            g_error_free(error);
-        }
-        return ok != FALSE;
+        // The root attribute lets loadMany() find every item under the root
+        // in one search.
+        const Attributes attributes({{"service", serviceName(namespaceName)},
+                                     {"account", accountName(namespaceName, key)},
+                                     {"root", linuxVaultRootName()}});
+        const std::string label = displayLabel(namespaceName, key);
+        std::string error;
+        const bool ok = SecretServiceConnection::instance().run(
+            error,
+            [&](SecretService* service, GCancellable* cancellable, GAsyncReadyCallback callback, gpointer userData) {
+                SecretValue* secret = secret_value_new(value.data(), static_cast<long>(value.size()), "text/plain");
+                secret_service_store(service, &schema(), attributes.table(), SECRET_COLLECTION_DEFAULT,
+                                     label.c_str(), secret, cancellable, callback, userData);
+                secret_value_unref(secret);
+            },
+            [](SecretService* service, GAsyncResult* result, std::string& message) {
+                GError* failure = nullptr;
+                const gboolean stored = secret_service_store_finish(service, result, &failure);
+                return finished(stored != FALSE, failure, message);
+            });
+        setLastError(std::move(error));
+        return ok;
     }
 
     std::optional<std::string> load(std::string_view namespaceName, std::string_view key) override {
         if (envFlagEnabled("SAFEKEEPING_DISABLE_SYSTEM_VAULT")) {
             return std::nullopt;
         }
-        const std::string account = accountName(namespaceName, key);
-        const std::string service = serviceName(namespaceName);
-        GError* error = nullptr;
-        gchar* secret = secret_password_lookup_sync(
-            &schema(),
-            nullptr,
-            &error,
-            "service", service.c_str(),
-            "account", account.c_str(),
-            nullptr);
-        if (error != nullptr) {
-            g_error_free(error);
-        }
-        if (secret == nullptr) {
-            return std::nullopt;
-        }
-        std::string result(secret);
-        secret_password_free(secret);
-        return result;
+        const auto attributes = itemAttributes(namespaceName, key);
+        std::optional<std::string> loaded;
+        std::string error;
+        SecretServiceConnection::instance().run(
+            error,
+            [&](SecretService* service, GCancellable* cancellable, GAsyncReadyCallback callback, gpointer userData) {
+                secret_service_lookup(service, &schema(), attributes.table(), cancellable, callback, userData);
+            },
+            [&loaded](SecretService* service, GAsyncResult* result, std::string& message) {
+                GError* failure = nullptr;
+                SecretValue* secret = secret_service_lookup_finish(service, result, &failure);
+                if (secret != nullptr) {
+                    std::size_t length = 0;
+                    const gchar* data = secret_value_get(secret, &length);
+                    loaded.emplace(data, length);
+                    secret_value_unref(secret);
+                }
+                return finished(secret != nullptr, failure, message);
+            });
+        setLastError(std::move(error));
+        return loaded;
     }
 
     bool remove(std::string_view namespaceName, std::string_view key) override {
         if (envFlagEnabled("SAFEKEEPING_DISABLE_SYSTEM_VAULT")) {
             return false;
         }
-        const std::string account = accountName(namespaceName, key);
-        const std::string service = serviceName(namespaceName);
-        GError* error = nullptr;
-        const gboolean ok = secret_password_clear_sync(
-            &schema(),
-            nullptr,
-            &error,
-            "service", service.c_str(),
-            "account", account.c_str(),
-            nullptr);
-        if (error != nullptr) {
-            g_error_free(error);
+        const auto attributes = itemAttributes(namespaceName, key);
+        std::string error;
+        const bool ok = SecretServiceConnection::instance().run(
+            error,
+            [&](SecretService* service, GCancellable* cancellable, GAsyncReadyCallback callback, gpointer userData) {
+                secret_service_clear(service, &schema(), attributes.table(), cancellable, callback, userData);
+            },
+            [](SecretService* service, GAsyncResult* result, std::string& message) {
+                GError* failure = nullptr;
+                const gboolean cleared = secret_service_clear_finish(service, result, &failure);
+                return finished(cleared != FALSE, failure, message);
+            });
+        setLastError(std::move(error));
+        return ok;
+    }
+
+    // One search for every item under the root, with their secrets. Items
+    // stored before the root attribute existed are not found, and are
+    // loaded one by one on unlock as before.
+    std::map<std::string, std::string> loadMany(std::span<const std::string> namespaceNames,
+                                                std::string_view key) override {
+        std::map<std::string, std::string> loaded;
+        if (envFlagEnabled("SAFEKEEPING_DISABLE_SYSTEM_VAULT")) {
+            return loaded;
         }
-        return ok != FALSE;
+        std::map<std::string, std::string, std::less<>> wanted;
+        for (const auto& namespaceName : namespaceNames) {
+            wanted.emplace(accountName(namespaceName, key), namespaceName);
+        }
+        const Attributes attributes({{"root", linuxVaultRootName()}});
+        std::string error;
+        SecretServiceConnection::instance().run(
+            error,
+            [&](SecretService* service, GCancellable* cancellable, GAsyncReadyCallback callback, gpointer userData) {
+                const auto flags = static_cast<SecretSearchFlags>(SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK
+                                                                  | SECRET_SEARCH_LOAD_SECRETS);
+                secret_service_search(service, &schema(), attributes.table(), flags, cancellable, callback, userData);
+            },
+            [&](SecretService* service, GAsyncResult* result, std::string& message) {
+                GError* failure = nullptr;
+                GList* items = secret_service_search_finish(service, result, &failure);
+                for (GList* node = items; node != nullptr; node = node->next) {
+                    auto* item = static_cast<SecretItem*>(node->data);
+                    GHashTable* itemAttributes = secret_item_get_attributes(item);
+                    const auto* account = static_cast<const gchar*>(g_hash_table_lookup(itemAttributes, "account"));
+                    const auto match = account != nullptr ? wanted.find(std::string_view(account)) : wanted.end();
+                    if (SecretValue* secret = match != wanted.end() ? secret_item_get_secret(item) : nullptr) {
+                        std::size_t length = 0;
+                        const gchar* data = secret_value_get(secret, &length);
+                        loaded.insert_or_assign(match->second, std::string(data, length));
+                        secret_value_unref(secret);
+                    }
+                    g_hash_table_unref(itemAttributes);
+                }
+                g_list_free_full(items, g_object_unref);
+                return finished(failure == nullptr, failure, message);
+            });
+        setLastError(std::move(error));
+        return loaded;
+    }
+
+    [[nodiscard]] std::string lastErrorMessage() const override {
+        const std::scoped_lock lock(errorMutex_);
+        return lastError_;
     }
 
 private:
+    // An attribute table. The strings are owned here and only borrowed by
+    // the table.
+    class Attributes {
+    public:
+        explicit Attributes(std::vector<std::pair<const char*, std::string>> values)
+            : values_(std::move(values)),
+              table_(g_hash_table_new(g_str_hash, g_str_equal)) {
+            for (auto& [name, value] : values_) {
+                g_hash_table_insert(table_, const_cast<char*>(name), value.data());
+            }
+        }
+
+        Attributes(const Attributes&) = delete;
+        Attributes& operator=(const Attributes&) = delete;
+
+        ~Attributes() {
+            g_hash_table_unref(table_);
+        }
+
+        [[nodiscard]] GHashTable* table() const {
+            return table_;
+        }
+
+    private:
+        std::vector<std::pair<const char*, std::string>> values_;
+        GHashTable* table_;
+    };
+
+    // Lookups match on service and account only, so they also find items
+    // stored without the root attribute.
+    static Attributes itemAttributes(std::string_view namespaceName, std::string_view key) {
+        return Attributes({{"service", serviceName(namespaceName)}, {"account", accountName(namespaceName, key)}});
+    }
+
+    static bool finished(bool ok, GError* failure, std::string& message) {
+        if (failure != nullptr) {
+            message = failure->message;
+            g_error_free(failure);
+        }
+        return ok;
+    }
+
+    void setLastError(std::string message) {
+        const std::scoped_lock lock(errorMutex_);
+        lastError_ = std::move(message);
+    }
+
     static SecretSchema& schema() {
         static SecretSchema schemaValue = {
             "SafeKeepingSchema",
             SECRET_SCHEMA_DONT_MATCH_NAME,
             {{"service", SECRET_SCHEMA_ATTRIBUTE_STRING},
              {"account", SECRET_SCHEMA_ATTRIBUTE_STRING},
+             {"root", SECRET_SCHEMA_ATTRIBUTE_STRING},
              {nullptr, SECRET_SCHEMA_ATTRIBUTE_STRING}},
         };
         return schemaValue;
@@ -758,6 +2215,9 @@ private:
     static std::string displayLabel(std::string_view namespaceName, std::string_view key) {
         return linuxVaultRootName() + "/" + accountName(namespaceName, key);
     }
+
+    mutable std::mutex errorMutex_;
+    std::string lastError_;
 };
 #elif defined(__APPLE__)
 class MacVaultBackend final : public VaultBackend {
@@ -942,6 +2402,14 @@ struct SlotRecord {
     bytes wrappedDek;
 };
 
+struct EncryptedInfo {
+    bytes nameHash;
+    bytes nameNonce;
+    bytes nameCiphertext;
+    std::optional<bytes> descriptionNonce;
+    std::optional<bytes> descriptionCiphertext;
+};
+
 struct SecretRecord {
     bytes nameHash;
     bytes nameNonce;
@@ -950,15 +2418,14 @@ struct SecretRecord {
     bytes valueCiphertext;
     std::optional<bytes> descriptionNonce;
     std::optional<bytes> descriptionCiphertext;
+    // Set for streamed secrets, whose value is an encoded StreamManifest.
+    std::optional<bytes> streamId;
 };
 
-[[nodiscard]] SlotRecord readSingleSlot(sqlite3* db, std::string_view slotType) {
-    auto stmt = prepare(
-        db,
-        "SELECT slot_id, slot_type, kdf_name, kdf_salt, kdf_opslimit, kdf_memlimit, nonce, wrapped_dek "
-        "FROM key_slots WHERE status = 'active' AND slot_type = ? LIMIT 1");
+[[nodiscard]] SlotRecord readSingleSlot(StatementCache& statements, std::string_view slotType) {
+    auto stmt = statements.acquire(StatementId::ReadSingleSlot);
     bindText(stmt.get(), 1, slotType);
-    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+    if (stepStatement(stmt.get()) != SQLITE_ROW) {
         throw std::runtime_error("slot not found");
     }
 
@@ -976,29 +2443,29 @@ struct SecretRecord {
     return record;
 }
 
-[[nodiscard]] int activeSlotCount(sqlite3* db) {
-    auto stmt = prepare(db, "SELECT COUNT(*) FROM key_slots WHERE status = 'active'");
-    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+[[nodiscard]] int activeSlotCount(StatementCache& statements) {
+    auto stmt = statements.acquire(StatementId::ActiveSlotCount);
+    if (stepStatement(stmt.get()) != SQLITE_ROW) {
         throw std::runtime_error("failed to count key slots");
     }
     return sqlite3_column_int(stmt.get(), 0);
 }
 
-[[nodiscard]] bool hasSlot(sqlite3* db, std::string_view slotType) {
-    auto stmt = prepare(db, "SELECT 1 FROM key_slots WHERE status = 'active' AND slot_type = ? LIMIT 1");
+[[nodiscard]] bool hasSlot(StatementCache& statements, std::string_view slotType) {
+    auto stmt = statements.acquire(StatementId::HasSlot);
     bindText(stmt.get(), 1, slotType);
-    return sqlite3_step(stmt.get()) == SQLITE_ROW;
+    return stepStatement(stmt.get()) == SQLITE_ROW;
 }
 
-[[nodiscard]] std::vector<SafeKeeping::UnlockMethod> listUnlockMethods(sqlite3* db) {
+[[nodiscard]] std::vector<SafeKeeping::UnlockMethod> listUnlockMethods(StatementCache& statements) {
     std::vector<SafeKeeping::UnlockMethod> methods;
-    if (hasSlot(db, kSlotTypeVault)) {
+    if (hasSlot(statements, kSlotTypeVault)) {
         methods.push_back(SafeKeeping::UnlockMethod::SystemVault);
     }
-    if (hasSlot(db, kSlotTypePassphrase)) {
+    if (hasSlot(statements, kSlotTypePassphrase)) {
         methods.push_back(SafeKeeping::UnlockMethod::Passphrase);
     }
-    if (hasSlot(db, kSlotTypeRecovery)) {
+    if (hasSlot(statements, kSlotTypeRecovery)) {
         methods.push_back(SafeKeeping::UnlockMethod::RecoveryKey);
     }
     return methods;
@@ -1015,7 +2482,7 @@ struct SecretRecord {
 
 [[nodiscard]] SlotRecord buildWrappedSlot(std::string slotId,
                                           std::string slotType,
-                                          const bytes& dek,
+                                          key_view dek,
                                           const bytes& kek,
                                           std::optional<std::string> kdfName,
                                           std::optional<bytes> kdfSalt,
@@ -1036,12 +2503,25 @@ struct SecretRecord {
     return slot;
 }
 
-void insertSlot(sqlite3* db, const SlotRecord& slot, std::optional<std::string> label = std::nullopt) {
-    auto stmt = prepare(
-        db,
-        "INSERT INTO key_slots (slot_id, slot_type, status, kdf_name, kdf_salt, kdf_opslimit, "
-        "kdf_memlimit, nonce, wrapped_dek, created_at, updated_at, label) "
-        "VALUES (?, ?, 'active', ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+[[nodiscard]] SlotRecord buildKdfSlot(std::string_view slotType,
+                                      key_view dek,
+                                      const bytes& kek,
+                                      const bytes& salt,
+                                      const KdfParams& params) {
+    return buildWrappedSlot(std::string(slotType),
+                            std::string(slotType),
+                            dek,
+                            kek,
+                            std::string("argon2id"),
+                            salt,
+                            static_cast<std::int64_t>(params.opslimit),
+                            static_cast<std::int64_t>(params.memlimit));
+}
+
+void insertSlot(StatementCache& statements,
+                const SlotRecord& slot,
+                std::optional<std::string> label = std::nullopt) {
+    auto stmt = statements.acquire(StatementId::InsertSlot);
     const auto now = nowSeconds();
     bindText(stmt.get(), 1, slot.slotId);
     bindText(stmt.get(), 2, slot.slotType);
@@ -1054,20 +2534,20 @@ void insertSlot(sqlite3* db, const SlotRecord& slot, std::optional<std::string>
     bindInt64(stmt.get(), 9, now);
     bindInt64(stmt.get(), 10, now);
     bindOptionalText(stmt.get(), 11, label);
-    stepDone(db, stmt.get());
+    stepDone(statements.db(), stmt.get());
 }
 
-void removeActiveSlot(sqlite3* db, std::string_view slotType) {
-    auto stmt = prepare(db, "DELETE FROM key_slots WHERE status = 'active' AND slot_type = ?");
+void removeActiveSlot(StatementCache& statements, std::string_view slotType) {
+    auto stmt = statements.acquire(StatementId::RemoveActiveSlot);
     bindText(stmt.get(), 1, slotType);
-    stepDone(db, stmt.get());
+    stepDone(statements.db(), stmt.get());
 }
 
 void initializeSchema(sqlite3* db, std::string_view namespaceName) {
     execute(db, kSchema);
 
     auto countStmt = prepare(db, "SELECT COUNT(*) FROM metadata");
-    if (sqlite3_step(countStmt.get()) != SQLITE_ROW) {
+    if (stepStatement(countStmt.get()) != SQLITE_ROW) {
         throw std::runtime_error("failed to count metadata rows");
     }
     if (sqlite3_column_int(countStmt.get(), 0) > 0) {
@@ -1085,20 +2565,86 @@ void initializeSchema(sqlite3* db, std::string_view namespaceName) {
     stepDone(db, insert.get());
 }
 
-void validateSchema(sqlite3* db, std::string_view namespaceName) {
-    auto stmt = prepare(db, "SELECT schema_version, namespace_name FROM metadata LIMIT 1");
-    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+[[nodiscard]] int schemaVersion(sqlite3* db) {
+    auto stmt = prepare(db, "SELECT schema_version FROM metadata LIMIT 1");
+    if (stepStatement(stmt.get()) != SQLITE_ROW) {
         throw std::runtime_error("metadata row is missing");
     }
-    if (sqlite3_column_int(stmt.get(), 0) != kSchemaVersion) {
+    return sqlite3_column_int(stmt.get(), 0);
+}
+
+// Bring an older database up to kSchemaVersion. The version is read again
+// inside the write transaction, so concurrent openers migrate only once.
+void migrateSchema(sqlite3* db) {
+    Transaction txn(db);
+    if (schemaVersion(db) == 1) {
+        execute(db, kMigrateSchema1To2);
+    }
+    txn.commit();
+}
+
+// Throws if the schema is unsupported or belongs to another namespace.
+// Returns false if it is older and needs migrateSchema(), which takes a
+// writer; a read-only connection is enough for the check.
+[[nodiscard]] bool checkSchema(sqlite3* db, std::string_view namespaceName) {
+    const int version = schemaVersion(db);
+    if (version < 1 || version > kSchemaVersion) {
         throw std::runtime_error("unsupported schema version");
     }
-    if (columnText(stmt.get(), 1) != namespaceName) {
+
+    auto stmt = prepare(db, "SELECT namespace_name FROM metadata LIMIT 1");
+    if (stepStatement(stmt.get()) != SQLITE_ROW) {
+        throw std::runtime_error("metadata row is missing");
+    }
+    if (columnText(stmt.get(), 0) != namespaceName) {
         throw std::runtime_error("namespace metadata mismatch");
     }
+    return version == kSchemaVersion;
+}
+
+// Set a pragma unless the connection already reports `value`. journal_mode
+// is stored in the database, and changing it takes a write lock.
+void ensurePragma(sqlite3* db, std::string_view name, std::string_view value) {
+    auto stmt = prepare(db, "PRAGMA " + std::string(name));
+    if (stepStatement(stmt.get()) == SQLITE_ROW && columnText(stmt.get(), 0) == value) {
+        return;
+    }
+    stmt.reset();
+    execute(db, "PRAGMA " + std::string(name) + " = " + std::string(value));
+}
+
+// Add a namespace to the shared store and return its id.
+[[nodiscard]] std::int64_t insertSharedNamespace(sqlite3* db, std::string_view namespaceName) {
+    auto insert = prepare(db,
+                          "INSERT INTO metadata (schema_version, created_at, updated_at, namespace_name) "
+                          "VALUES (?, ?, ?, ?) ON CONFLICT(namespace_name) DO NOTHING");
+    const auto now = nowSeconds();
+    bindInt64(insert.get(), 1, kSchemaVersion);
+    bindInt64(insert.get(), 2, now);
+    bindInt64(insert.get(), 3, now);
+    bindText(insert.get(), 4, namespaceName);
+    stepDone(db, insert.get());
+    if (sqlite3_changes(db) == 0) {
+        throw std::runtime_error("namespace already exists");
+    }
+    return sqlite3_last_insert_rowid(db);
+}
+
+[[nodiscard]] std::optional<std::int64_t> sharedNamespaceId(sqlite3* db, std::string_view namespaceName) {
+    auto stmt = prepare(db, "SELECT namespace_id, schema_version FROM metadata WHERE namespace_name = ?");
+    bindText(stmt.get(), 1, namespaceName);
+    if (stepStatement(stmt.get()) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+    if (sqlite3_column_int(stmt.get(), 1) != kSchemaVersion) {
+        throw std::runtime_error("unsupported schema version");
+    }
+    return sqlite3_column_int64(stmt.get(), 0);
 }
 
-sqlite_ptr openDatabase(const std::filesystem::path& dbPath, bool createIfMissing) {
+sqlite_ptr openDatabase(const std::filesystem::path& dbPath,
+                        bool createIfMissing,
+                        SafeKeeping::Durability durability) {
     ensurePrivateDirectory(dbPath.parent_path());
 
     sqlite3* rawDb = nullptr;
@@ -1116,35 +2662,709 @@ sqlite_ptr openDatabase(const std::filesystem::path& dbPath, bool createIfMissin
     sqlite_ptr db(rawDb);
     sqlite3_busy_timeout(db.get(), 5000);
     execute(db.get(), "PRAGMA foreign_keys = ON");
-    execute(db.get(), "PRAGMA journal_mode = WAL");
-    execute(db.get(), "PRAGMA synchronous = FULL");
+    ensurePragma(db.get(), "journal_mode", "wal");
+    // Deferred mode syncs once per group commit, so it keeps FULL.
+    ensurePragma(db.get(), "synchronous", durability == SafeKeeping::Durability::Normal ? "1" : "2");
     lockDownDatabaseArtifacts(dbPath);
     return db;
 }
 
+// Read-only connection for one reader at a time. Pool leases are never shared
+// between threads, so SQLite's per-connection mutex is not needed. A non-zero
+// `mmapSize` reads pages through a shared memory map instead of the page cache.
+sqlite_ptr openReadConnection(const std::filesystem::path& dbPath, std::int64_t mmapSize = 0) {
+    sqlite3* rawDb = nullptr;
+    const int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+    if (sqlite3_open_v2(dbPath.string().c_str(), &rawDb, flags, nullptr) != SQLITE_OK) {
+        const std::string message = rawDb != nullptr ? sqlite3_errmsg(rawDb) : "failed to open sqlite database";
+        if (rawDb != nullptr) {
+            sqlite3_close(rawDb);
+        }
+        throw std::runtime_error(message);
+    }
+
+    sqlite_ptr db(rawDb);
+    sqlite3_busy_timeout(db.get(), 5000);
+    if (mmapSize > 0) {
+        execute(db.get(), "PRAGMA mmap_size = " + std::to_string(mmapSize));
+    }
+    return db;
+}
+
+[[nodiscard]] bool sharedStoreContains(std::string_view namespaceName) {
+    const auto dbPath = sharedDatabasePath();
+    if (!std::filesystem::exists(dbPath)) {
+        return false;
+    }
+    const auto db = openReadConnection(dbPath);
+    return sharedNamespaceId(db.get(), namespaceName).has_value();
+}
+
+// Slots, secrets and chunks go with the metadata row.
+bool removeFromSharedStore(std::string_view namespaceName) {
+    const auto dbPath = sharedDatabasePath();
+    if (!std::filesystem::exists(dbPath)) {
+        return false;
+    }
+    const auto db = openDatabase(dbPath, false, SafeKeeping::Durability::Full);
+    auto stmt = prepare(db.get(), "DELETE FROM metadata WHERE namespace_name = ?");
+    bindText(stmt.get(), 1, namespaceName);
+    stepDone(db.get(), stmt.get());
+    return sqlite3_changes(db.get()) > 0;
+}
+
+// Pool of WAL read connections, each with its own statement cache.
+//
+// WAL lets readers run next to the writer without blocking it. A thread checks
+// a connection out for one operation and the lease returns it on destruction.
+// The pool grows on demand and keeps up to one idle connection per hardware
+// thread. Namespaces in the shared store share one pool; each lease's
+// statements are bound to the namespace it was acquired for.
+class ReadConnectionPool {
+public:
+    struct Connection {
+        explicit Connection(sqlite_ptr connection)
+            : db(std::move(connection)), statements(db.get()) {}
+
+        sqlite_ptr db;
+        // Declared after db so cached statements are finalized first.
+        StatementCache statements;
+        // Pool generation it was opened in; older ones are closed on release.
+        std::uint64_t generation = 0;
+    };
+
+    class Lease {
+    public:
+        Lease(ReadConnectionPool& pool, std::unique_ptr<Connection> connection) noexcept
+            : pool_(&pool), connection_(std::move(connection)) {}
+
+        Lease(Lease&& other) noexcept
+            : pool_(other.pool_), connection_(std::move(other.connection_)) {}
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease() {
+            if (connection_) {
+                pool_->release(std::move(connection_));
+            }
+        }
+
+        [[nodiscard]] sqlite3* db() const noexcept {
+            return connection_->db.get();
+        }
+
+        [[nodiscard]] StatementCache& statements() const noexcept {
+            return connection_->statements;
+        }
+
+    private:
+        ReadConnectionPool* pool_;
+        std::unique_ptr<Connection> connection_;
+    };
+
+    explicit ReadConnectionPool(std::filesystem::path dbPath, std::int64_t mmapSize = 0)
+        : dbPath_(std::move(dbPath)),
+          mmapSize_(mmapSize),
+          maxIdle_(std::max<std::size_t>(2, std::thread::hardware_concurrency())) {
+        // release() must not allocate.
+        idle_.reserve(maxIdle_);
+    }
+
+    ReadConnectionPool(const ReadConnectionPool&) = delete;
+    ReadConnectionPool& operator=(const ReadConnectionPool&) = delete;
+
+    [[nodiscard]] Lease acquire(std::optional<std::int64_t> namespaceId = std::nullopt) {
+        std::unique_ptr<Connection> connection;
+        std::uint64_t generation = 0;
+        {
+            const std::scoped_lock lock(mutex_);
+            if (!idle_.empty()) {
+                connection = std::move(idle_.back());
+                idle_.pop_back();
+            }
+            generation = generation_;
+        }
+        if (!connection) {
+            connection = std::make_unique<Connection>(openReadConnection(dbPath_, mmapSize_));
+            connection->generation = generation;
+        }
+        connection->statements.setNamespaceId(namespaceId);
+        return Lease(*this, std::move(connection));
+    }
+
+    // Close every idle connection. Leased connections are closed when they
+    // are returned.
+    void clear() {
+        std::vector<std::unique_ptr<Connection>> closing;
+        {
+            const std::scoped_lock lock(mutex_);
+            closing.swap(idle_);
+            idle_.reserve(maxIdle_);
+            ++generation_;
+        }
+    }
+
+    // Calls `fn` with each idle connection. Leased ones are in use elsewhere.
+    template <typename Fn>
+    void forEachIdle(Fn&& fn) {
+        const std::scoped_lock lock(mutex_);
+        for (const auto& connection : idle_) {
+            fn(connection->db.get());
+        }
+    }
+
+private:
+    void release(std::unique_ptr<Connection> connection) noexcept {
+        const std::scoped_lock lock(mutex_);
+        if (idle_.size() < maxIdle_ && connection->generation == generation_) {
+            idle_.push_back(std::move(connection));
+        }
+    }
+
+    std::filesystem::path dbPath_;
+    std::int64_t mmapSize_;
+    std::size_t maxIdle_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Connection>> idle_;
+    std::uint64_t generation_ = 0;
+};
+
+// Plaintext of one audit log entry: time in microseconds since the epoch,
+// operation, outcome, name length and the name, zero padded. Each entry is
+// stored as nonce + ciphertext, so the log is a sequence of fixed frames.
+struct AuditRecord {
+    static constexpr std::size_t kMaxName = 128;
+    static constexpr std::size_t kEncodedSize = 144;
+    static constexpr std::size_t kFrameSize = crypto_aead_xchacha20poly1305_ietf_NPUBBYTES + kEncodedSize +
+        crypto_aead_xchacha20poly1305_ietf_ABYTES;
+
+    std::int64_t timeMicros = 0;
+    std::uint8_t operation = 0;
+    std::uint8_t outcome = 0;
+    std::uint8_t nameLength = 0;
+    std::array<char, kMaxName> name{};
+
+    [[nodiscard]] std::array<unsigned char, kEncodedSize> encode() const {
+        std::array<unsigned char, kEncodedSize> out{};
+        for (std::size_t i = 0; i < 8; ++i) {
+            out[i] = static_cast<unsigned char>(static_cast<std::uint64_t>(timeMicros) >> (8 * i));
+        }
+        out[8] = operation;
+        out[9] = outcome;
+        out[10] = nameLength;
+        std::memcpy(out.data() + 11, name.data(), nameLength);
+        return out;
+    }
+
+    [[nodiscard]] static AuditRecord decode(std::span<const unsigned char> encoded) {
+        if (encoded.size() != kEncodedSize || encoded[8] >= SafeKeeping::kOperationCount ||
+            encoded[9] >= SafeKeeping::kErrorCount || encoded[10] > kMaxName) {
+            fail(SafeKeeping::Error::DataCorrupted, "audit record is malformed");
+        }
+        AuditRecord record;
+        std::uint64_t time = 0;
+        for (std::size_t i = 0; i < 8; ++i) {
+            time |= static_cast<std::uint64_t>(encoded[i]) << (8 * i);
+        }
+        record.timeMicros = static_cast<std::int64_t>(time);
+        record.operation = encoded[8];
+        record.outcome = encoded[9];
+        record.nameLength = encoded[10];
+        std::memcpy(record.name.data(), encoded.data() + 11, record.nameLength);
+        return record;
+    }
+};
+
+// Encrypted audit trail for OpenOptions::audit.
+//
+// Callers push records into a bounded lock-free ring (a Vyukov queue with
+// one consumer). A writer thread drains it every flush interval, encrypts
+// the records with the audit key and appends them to the log in one write.
+// Without keys, that is while the namespace is locked, records stay in the
+// ring, and a full ring drops them under either overflow policy since
+// waiting could take forever.
+class AuditLog {
+public:
+    using key_source_t = std::function<std::shared_ptr<const KeySchedule>()>;
+
+    AuditLog(std::filesystem::path path,
+             std::string namespaceName,
+             const SafeKeeping::AuditOptions& options,
+             key_source_t keys)
+        : path_(std::move(path)),
+          ad_(std::string(kAadAuditRecord) + namespaceName),
+          overflow_(options.overflow),
+          interval_(std::max(options.flushInterval, std::chrono::milliseconds{1})),
+          capacity_(std::bit_ceil(std::max<std::size_t>(options.capacity, 2))),
+          slots_(std::make_unique<Slot[]>(capacity_)),
+          keys_(std::move(keys)) {
+        for (std::size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        writer_ = std::thread([this] {
+            run();
+        });
+    }
+
+    AuditLog(const AuditLog&) = delete;
+    AuditLog& operator=(const AuditLog&) = delete;
+
+    // Writes what is left if the namespace is still unlocked.
+    ~AuditLog() {
+        {
+            const std::scoped_lock lock(wakeMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        writer_.join();
+    }
+
+    void record(SafeKeeping::Operation operation, std::string_view name, SafeKeeping::Error outcome) {
+        AuditRecord record;
+        record.timeMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+                                std::chrono::system_clock::now().time_since_epoch())
+                                .count();
+        record.operation = static_cast<std::uint8_t>(operation);
+        record.outcome = static_cast<std::uint8_t>(outcome);
+        record.nameLength = static_cast<std::uint8_t>(std::min(name.size(), AuditRecord::kMaxName));
+        std::memcpy(record.name.data(), name.data(), record.nameLength);
+        recorded_.fetch_add(1, std::memory_order_relaxed);
+
+        bool waited = false;
+        for (;;) {
+            const auto seen = progress_.load(std::memory_order_acquire);
+            if (tryPush(record)) {
+                return;
+            }
+            if (overflow_ == SafeKeeping::AuditOverflow::Drop || keys_() == nullptr) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            if (!waited) {
+                blocked_.fetch_add(1, std::memory_order_relaxed);
+                waited = true;
+            }
+            {
+                const std::scoped_lock lock(wakeMutex_);
+                wakeRequested_ = true;
+            }
+            wake_.notify_one();
+            progress_.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    // Write everything pushed so far, if the namespace is unlocked.
+    void flush() {
+        drain();
+    }
+
+    [[nodiscard]] SafeKeeping::AuditStats stats() const {
+        return {
+            .recorded = recorded_.load(std::memory_order_relaxed),
+            .written = written_.load(std::memory_order_relaxed),
+            .dropped = dropped_.load(std::memory_order_relaxed),
+            .blocked = blocked_.load(std::memory_order_relaxed),
+            .writeFailures = writeFailures_.load(std::memory_order_relaxed),
+        };
+    }
+
+    // Decrypt the whole log. A torn last frame from a crash is ignored.
+    [[nodiscard]] std::vector<SafeKeeping::AuditEvent> read(const KeySchedule& keys) {
+        const std::scoped_lock lock(drainMutex_);
+        std::vector<SafeKeeping::AuditEvent> events;
+        std::ifstream in(path_, std::ios::binary);
+        if (!in) {
+            return events;
+        }
+        constexpr std::size_t kNonceBytes = crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+        std::array<unsigned char, AuditRecord::kFrameSize> frame{};
+        std::array<unsigned char, AuditRecord::kEncodedSize> plaintext{};
+        while (in.read(reinterpret_cast<char*>(frame.data()), frame.size())) {
+            try {
+                aeadDecryptInto(std::span(frame).subspan(kNonceBytes),
+                                std::span(frame).first(kNonceBytes),
+                                keys.auditKey(),
+                                ad_,
+                                plaintext);
+            } catch (const std::exception&) {
+                fail(SafeKeeping::Error::DataCorrupted, "audit log failed authentication");
+            }
+            const auto record = AuditRecord::decode(plaintext);
+            events.push_back({
+                .time = std::chrono::system_clock::time_point{std::chrono::microseconds{record.timeMicros}},
+                .operation = static_cast<SafeKeeping::Operation>(record.operation),
+                .outcome = static_cast<SafeKeeping::Error>(record.outcome),
+                .name = std::string(record.name.data(), record.nameLength),
+            });
+        }
+        sodium_memzero(plaintext.data(), plaintext.size());
+        return events;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        AuditRecord record;
+    };
+
+    bool tryPush(const AuditRecord& record) noexcept {
+        auto position = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& slot = slots_[position & (capacity_ - 1)];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.record = record;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Single consumer; callers hold drainMutex_.
+    bool tryPop(AuditRecord& out) noexcept {
+        auto& slot = slots_[tail_ & (capacity_ - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != tail_ + 1) {
+            return false;
+        }
+        out = slot.record;
+        slot.sequence.store(tail_ + capacity_, std::memory_order_release);
+        ++tail_;
+        return true;
+    }
+
+    void drain() noexcept {
+        {
+            const std::scoped_lock lock(drainMutex_);
+            try {
+                if (const auto keys = keys_(); keys != nullptr) {
+                    writeBatch(*keys);
+                }
+            } catch (const std::exception&) {
+                // Encryption only fails when memory runs out. Records popped
+                // before that are lost; the rest wait for the next round.
+            }
+        }
+        progress_.fetch_add(1, std::memory_order_release);
+        progress_.notify_all();
+    }
+
+    void writeBatch(const KeySchedule& keys) {
+        bytes batch;
+        std::uint64_t count = 0;
+        AuditRecord record;
+        while (tryPop(record)) {
+            auto plaintext = record.encode();
+            bytes nonce;
+            const auto ciphertext = aeadEncrypt(plaintext, keys.auditKey(), ad_, nonce);
+            sodium_memzero(plaintext.data(), plaintext.size());
+            batch.insert(batch.end(), nonce.begin(), nonce.end());
+            batch.insert(batch.end(), ciphertext.begin(), ciphertext.end());
+            ++count;
+        }
+        if (count == 0) {
+            return;
+        }
+        const bool created = !std::filesystem::exists(path_);
+        if (created) {
+            // Namespaces in the shared store have no directory of their own yet.
+            ensurePrivateDirectory(path_.parent_path());
+        } else if (!dropTornFrame()) {
+            writeFailures_.fetch_add(count, std::memory_order_relaxed);
+            return;
+        }
+        std::ofstream out(path_, std::ios::binary | std::ios::app);
+        out.write(reinterpret_cast<const char*>(batch.data()), static_cast<std::streamsize>(batch.size()));
+        out.close();
+        if (!out.good()) {
+            writeFailures_.fetch_add(count, std::memory_order_relaxed);
+            return;
+        }
+        if (created) {
+            lockDownPath(path_, false);
+        }
+        written_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // A crash or a short write can leave a partial frame at the end. Cut
+    // it off before appending, so the frames after it stay aligned.
+    [[nodiscard]] bool dropTornFrame() const {
+        std::error_code error;
+        const auto size = std::filesystem::file_size(path_, error);
+        if (error) {
+            return false;
+        }
+        if (const auto torn = size % AuditRecord::kFrameSize; torn != 0) {
+            std::filesystem::resize_file(path_, size - torn, error);
+        }
+        return !error;
+    }
+
+    void run() {
+        for (;;) {
+            bool stopping = false;
+            {
+                std::unique_lock lock(wakeMutex_);
+                wake_.wait_for(lock, interval_, [this] {
+                    return stopping_ || wakeRequested_;
+                });
+                wakeRequested_ = false;
+                stopping = stopping_;
+            }
+            drain();
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    const std::filesystem::path path_;
+    const std::string ad_;
+    const SafeKeeping::AuditOverflow overflow_;
+    const std::chrono::milliseconds interval_;
+    const std::size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    key_source_t keys_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::size_t tail_ = 0;
+    std::mutex drainMutex_;
+    std::atomic<std::uint64_t> progress_{0};
+    std::atomic<std::uint64_t> recorded_{0};
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> blocked_{0};
+    std::atomic<std::uint64_t> writeFailures_{0};
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    bool wakeRequested_ = false;
+    bool stopping_ = false;
+    std::thread writer_;
+};
+
+// Run `fn`, returning any error it throws instead of propagating it.
+template <typename T, typename Fn>
+SafeKeeping::result_t<T> runResultOperation(Fn&& fn) {
+    using failure_t = Unexpected<SafeKeeping::ErrorInfo>;
+    try {
+        return std::forward<Fn>(fn)();
+    } catch (const OperationError& error) {
+        return failure_t({.error = error.error(), .message = error.what()});
+    } catch (const std::invalid_argument& error) {
+        return failure_t({.error = SafeKeeping::Error::InvalidArgument, .message = error.what()});
+    } catch (const std::logic_error& error) {
+        return failure_t({.error = SafeKeeping::Error::Locked, .message = error.what()});
+    } catch (const std::runtime_error& error) {
+        return failure_t({.error = SafeKeeping::Error::StorageError, .message = error.what()});
+    } catch (const std::exception& error) {
+        return failure_t({.error = SafeKeeping::Error::InternalError, .message = error.what()});
+    }
+}
+
+// Error category of a finished call, for stats(). The bool and value APIs
+// only look at latestError() once the return value shows a failure.
+template <typename T>
+SafeKeeping::Error failureOf(const auto&, const SafeKeeping::result_t<T>& result) {
+    return result ? SafeKeeping::Error::None : result.error().error;
+}
+
+SafeKeeping::Error failureOf(const auto& impl, const auto& result) {
+    return result ? SafeKeeping::Error::None : impl.latestError().error;
+}
+
+template <typename T>
+SafeKeeping::Error failureOf(const auto& impl, const std::vector<T>& result) {
+    return result.empty() ? impl.latestError().error : SafeKeeping::Error::None;
+}
+
+// Run one public call as `operation` for stats() and the audit log, with
+// the phases it times on this thread attributed to the instance. Calls that
+// touch several secrets pass no `auditName` and audit each one themselves.
+template <typename Fn>
+auto measured(const auto& impl,
+              SafeKeeping::Operation operation,
+              std::optional<std::string_view> auditName,
+              Fn&& fn) {
+    const auto started = std::chrono::steady_clock::now();
+    auto result = [&] {
+        const OperationMetricsScope scope(impl.metrics());
+        return std::forward<Fn>(fn)();
+    }();
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    const auto error = failureOf(impl, result);
+    impl.metrics().recordOperation(operation, elapsed, error);
+    processMetrics().recordOperation(operation, elapsed, error);
+    if (auditName.has_value()) {
+        impl.audit(operation, *auditName, error);
+    }
+    return result;
+}
+
+template <typename Fn>
+auto measured(const auto& impl, SafeKeeping::Operation operation, Fn&& fn) {
+    return measured(impl, operation, std::string_view{}, std::forward<Fn>(fn));
+}
+
 } // namespace
 
+SecureBuffer::SecureBuffer(std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    ensureSodium();
+    data_ = static_cast<std::byte*>(sodium_malloc(size));
+    if (data_ == nullptr) {
+        throw std::bad_alloc();
+    }
+    size_ = size;
+}
+
+SecureBuffer::SecureBuffer(SecureBuffer&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+SecureBuffer& SecureBuffer::operator=(SecureBuffer&& other) noexcept {
+    if (this != &other) {
+        sodium_free(data_);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+SecureBuffer::~SecureBuffer() {
+    // sodium_free() wipes the memory before releasing it.
+    sodium_free(data_);
+}
+
+std::span<std::byte> SecureBuffer::span() noexcept {
+    return {data_, size_};
+}
+
+std::span<const std::byte> SecureBuffer::span() const noexcept {
+    return {data_, size_};
+}
+
+std::string_view SecureBuffer::view() const noexcept {
+    return {reinterpret_cast<const char*>(data_), size_};
+}
+
+struct SafeKeeping::WriteBatch::Operation {
+    bool remove = false;
+    std::string name;
+    std::vector<std::byte> value;
+    std::optional<std::string> description;
+
+    Operation() = default;
+    Operation(const Operation&) = delete;
+    Operation& operator=(const Operation&) = delete;
+    Operation(Operation&&) noexcept = default;
+    Operation& operator=(Operation&&) noexcept = default;
+
+    ~Operation() {
+        if (!value.empty()) {
+            sodium_memzero(value.data(), value.size());
+        }
+    }
+
+    [[nodiscard]] std::optional<std::string_view> descriptionView() const {
+        if (!description.has_value()) {
+            return std::nullopt;
+        }
+        return std::string_view(*description);
+    }
+};
+
 class SafeKeeping::Impl {
 public:
     Impl(std::string namespaceName,
          sqlite_ptr db,
          std::filesystem::path dbPath,
-         std::unique_ptr<VaultBackend> vaultBackend)
+         std::optional<std::int64_t> namespaceId,
+         std::unique_ptr<VaultBackend> vaultBackend,
+         const OpenOptions& openOptions)
         : namespaceName_(std::move(namespaceName)),
           db_(std::move(db)),
+          statements_(db_.get(), namespaceId),
           dbPath_(std::move(dbPath)),
-          vaultBackend_(std::move(vaultBackend)) {}
+          namespaceId_(namespaceId),
+          readers_(readPool(dbPath_, namespaceId_.has_value(), openOptions.readOnly ? kReadOnlyMmapSize : 0)),
+          // The shared store is checked when the namespace is looked up.
+          ready_(db_ != nullptr || namespaceId_.has_value()),
+          durability_(openOptions.durability),
+          groupCommitWindow_(openOptions.groupCommitWindow),
+          kdfOptions_(openOptions.kdf),
+          readOnly_(openOptions.readOnly),
+          closed_(db_ == nullptr) {
+        if (durability_ == Durability::Deferred && !readOnly_) {
+            groupCommitThread_ = std::thread([this] {
+                runGroupCommits();
+            });
+        }
+        if (vaultBackend != nullptr) {
+            std::call_once(vaultOnce_, [&] {
+                vaultBackend_ = std::move(vaultBackend);
+            });
+        }
+        if (openOptions.audit.has_value()) {
+            audit_ = std::make_unique<AuditLog>(namespacePath(namespaceName_) / kAuditLogFileName,
+                                                namespaceName_,
+                                                *openOptions.audit,
+                                                [this] {
+                                                    return currentKeys();
+                                                });
+        }
+        const std::scoped_lock lock(instancesMutex());
+        instances().push_back(this);
+    }
 
     ~Impl() {
-        lock();
+        clearLastError();
+        {
+            // First, so lockAll() never sees a partly destroyed instance.
+            const std::scoped_lock lock(instancesMutex());
+            std::erase(instances(), this);
+            destroyedInstances().fetch_add(1, std::memory_order_release);
+        }
+        {
+            std::unique_lock lock(asyncMutex_);
+            asyncIdle_.wait(lock, [this] {
+                return asyncPending_ == 0;
+            });
+        }
+        try {
+            lock();
+        } catch (const std::exception&) {
+            // Nothing more can be done with a failed final commit here.
+        }
+        if (groupCommitThread_.joinable()) {
+            {
+                const std::scoped_lock writeLock(writeMutex_);
+                stopGroupCommits_ = true;
+            }
+            groupCommitWake_.notify_all();
+            groupCommitThread_.join();
+        }
     }
 
     static CreateResult createNew(std::string namespaceName, const CreateOptions& options) {
         validateNamespaceOrSecretName(namespaceName, "namespace");
-        const auto dbPath = databasePath(namespaceName);
-        if (std::filesystem::exists(dbPath)) {
+        if (options.open.readOnly) {
+            throw std::invalid_argument("a namespace cannot be created read-only");
+        }
+        // Both layouts share the namespace's system-vault entry.
+        if (std::filesystem::exists(databasePath(namespaceName)) || sharedStoreContains(namespaceName)) {
             throw std::runtime_error("namespace already exists");
         }
+        const bool shared = storeLayout() == StoreLayout::Shared;
+        const auto dbPath = shared ? sharedDatabasePath() : databasePath(namespaceName);
 
         auto vaultBackend = makeVaultBackend();
         const bool vaultAvailable = vaultBackend != nullptr && vaultBackend->available();
@@ -1153,24 +3373,57 @@ public:
             throw std::runtime_error("no usable unlock method is available");
         }
 
-        const bytes dek = randomBytes(crypto_aead_xchacha20poly1305_ietf_KEYBYTES);
+        bytes dek = randomBytes(crypto_aead_xchacha20poly1305_ietf_KEYBYTES);
         std::optional<std::string> recoveryKeyString;
 
+        // Start both Argon2 derivations before the schema is written and the
+        // vault entry is stored, and collect them when their slots are built.
+        const auto slotKdf = kdfParams(options.open.kdf);
+        std::optional<PendingKek> passphraseKek;
+        if (options.passphrase.has_value()) {
+            passphraseKek = derivePassphraseKekAsync(*options.passphrase, slotKdf);
+        }
+        std::optional<PendingKek> recoveryKek;
+        if (options.createRecoveryKey) {
+            auto [formattedKey, rawRecovery] = generateRecoverySecret();
+            recoveryKek = derivePassphraseKekAsync(normalizeRecoveryKey(formattedKey), slotKdf);
+            recoveryKeyString = std::move(formattedKey);
+            sodium_memzero(rawRecovery.data(), rawRecovery.size());
+        }
+
+        // Set once this call owns the namespace, so a failure never cleans up
+        // after a concurrent creator of the same name.
+        bool created = !shared;
         try {
-            auto db = openDatabase(dbPath, true);
+            auto db = openDatabase(dbPath, true, options.open.durability);
+            std::optional<std::int64_t> namespaceId;
+            if (shared) {
+                // Outside the transaction: the tables stay for other namespaces.
+                execute(db.get(), kSharedSchema);
+            }
             Transaction txn(db.get());
-            initializeSchema(db.get(), namespaceName);
+            if (shared) {
+                namespaceId = insertSharedNamespace(db.get(), namespaceName);
+                created = true;
+            } else {
+                initializeSchema(db.get(), namespaceName);
+            }
+            StatementCache statements(db.get(), namespaceId);
 
             if (options.createSystemVaultSlot && vaultAvailable) {
                 const std::string vaultMaterial = bytesToHex(randomBytes(32));
-                if (!vaultBackend->store(namespaceName, kVaultEntryName, vaultMaterial)) {
+                const bool stored = [&] {
+                    const PhaseTimer timer(Phase::Vault);
+                    return vaultBackend->store(namespaceName, kVaultEntryName, vaultMaterial);
+                }();
+                if (!stored) {
                     const std::string detail = vaultBackend->lastErrorMessage();
                     throw std::runtime_error(
                         detail.empty() ? "failed to store vault material"
                                        : "failed to store vault material: " + detail);
                 }
                 const auto kek = deriveVaultKek(vaultMaterial);
-                insertSlot(db.get(),
+                insertSlot(statements,
                            buildWrappedSlot("vault",
                                             "vault",
                                             dek,
@@ -1181,563 +3434,2175 @@ public:
                                             0));
             }
 
-            if (options.passphrase.has_value()) {
-                const bytes salt = randomBytes(crypto_pwhash_SALTBYTES);
-                const auto kek = derivePassphraseKek(*options.passphrase,
-                                                     salt,
-                                                     crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                                                     crypto_pwhash_MEMLIMIT_INTERACTIVE);
-                insertSlot(db.get(),
-                           buildWrappedSlot("passphrase",
-                                            "passphrase",
-                                            dek,
-                                            kek,
-                                            std::string("argon2id"),
-                                            salt,
-                                            crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                                            crypto_pwhash_MEMLIMIT_INTERACTIVE));
-            }
-
-            if (options.createRecoveryKey) {
-                auto [formattedKey, rawRecovery] = generateRecoverySecret();
-                const bytes salt = randomBytes(crypto_pwhash_SALTBYTES);
-                const auto kek = derivePassphraseKek(normalizeRecoveryKey(formattedKey),
-                                                     salt,
-                                                     crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                                                     crypto_pwhash_MEMLIMIT_INTERACTIVE);
-                insertSlot(db.get(),
-                           buildWrappedSlot("recovery",
-                                            "recovery",
-                                            dek,
-                                            kek,
-                                            std::string("argon2id"),
-                                            salt,
-                                            crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                                            crypto_pwhash_MEMLIMIT_INTERACTIVE));
-                recoveryKeyString = formattedKey;
-                sodium_memzero(rawRecovery.data(), rawRecovery.size());
+            if (passphraseKek.has_value()) {
+                insertSlot(statements,
+                           buildKdfSlot(kSlotTypePassphrase, dek, passphraseKek->get(), passphraseKek->salt, slotKdf));
+            }
+
+            if (recoveryKek.has_value()) {
+                insertSlot(statements,
+                           buildKdfSlot(kSlotTypeRecovery, dek, recoveryKek->get(), recoveryKek->salt, slotKdf));
             }
 
-            if (activeSlotCount(db.get()) == 0 && options.requireAtLeastOneUnlockMethod) {
+            if (activeSlotCount(statements) == 0 && options.requireAtLeastOneUnlockMethod) {
                 throw std::runtime_error("namespace would be created without an unlock method");
             }
 
             txn.commit();
             lockDownDatabaseArtifacts(dbPath);
 
-            auto impl = std::make_unique<Impl>(namespaceName, std::move(db), dbPath, std::move(vaultBackend));
-            impl->dek_ = dek;
-            impl->unlocked_ = true;
+            auto impl = std::make_unique<Impl>(
+                namespaceName, std::move(db), dbPath, namespaceId, std::move(vaultBackend), options.open);
+            impl->setUnlockedDek(dek);
             return {.instance = std::unique_ptr<SafeKeeping>(new SafeKeeping(std::move(impl))),
                     .recoveryKey = recoveryKeyString};
         } catch (...) {
+            sodium_memzero(dek.data(), dek.size());
+            if (!created) {
+                throw;
+            }
             std::error_code ignored;
             if (vaultAvailable) {
                 vaultBackend->remove(namespaceName, kVaultEntryName);
             }
-            std::filesystem::remove_all(dbPath.parent_path(), ignored);
+            if (shared) {
+                try {
+                    // Only needed if the failure came after the commit.
+                    removeFromSharedStore(namespaceName);
+                } catch (const std::exception&) {
+                }
+            } else {
+                std::filesystem::remove_all(dbPath.parent_path(), ignored);
+            }
             throw;
         }
     }
 
-    static std::unique_ptr<SafeKeeping> open(std::string namespaceName, const UnlockOptions& options) {
-        validateNamespaceOrSecretName(namespaceName, "namespace");
-        const auto dbPath = databasePath(namespaceName);
-        if (!std::filesystem::exists(dbPath)) {
-            return nullptr;
+    static std::unique_ptr<SafeKeeping> open(std::string namespaceName, const UnlockOptions& options) {
+        validateNamespaceOrSecretName(namespaceName, "namespace");
+        if (options.open.readOnly && options.open.audit.has_value()) {
+            throw std::invalid_argument("a read-only instance cannot write an audit log");
+        }
+        const bool shared = storeLayout() == StoreLayout::Shared;
+        const auto dbPath = shared ? sharedDatabasePath() : databasePath(namespaceName);
+        if (!std::filesystem::exists(dbPath)) {
+            return nullptr;
+        }
+
+        // A namespace of its own is only opened, checked and hardened on
+        // first use. The shared store is looked up now, to find its id.
+        sqlite_ptr db;
+        std::optional<std::int64_t> namespaceId;
+        if (shared && options.open.readOnly) {
+            namespaceId = sharedNamespaceId(openReadConnection(dbPath).get(), namespaceName);
+            if (!namespaceId.has_value()) {
+                return nullptr;
+            }
+        } else if (shared) {
+            db = openDatabase(dbPath, false, options.open.durability);
+            namespaceId = sharedNamespaceId(db.get(), namespaceName);
+            if (!namespaceId.has_value()) {
+                return nullptr;
+            }
+        }
+
+        auto impl = std::make_unique<Impl>(
+            namespaceName, std::move(db), dbPath, namespaceId, nullptr, options.open);
+        auto result = std::unique_ptr<SafeKeeping>(new SafeKeeping(std::move(impl)));
+
+        result->impl_->unlockRequested(options);
+        return result;
+    }
+
+    // Open through the process-wide registry: one instance per namespace,
+    // shared while any handle to it is alive. Opening the same namespace
+    // again only runs the unlock attempts, and only if it is locked.
+    static std::shared_ptr<SafeKeeping> openShared(std::string namespaceName, const UnlockOptions& options) {
+        validateNamespaceOrSecretName(namespaceName, "namespace");
+        std::shared_ptr<SharedEntry> entry;
+        {
+            const std::scoped_lock lock(sharedMutex());
+            auto& entries = sharedEntries();
+            std::erase_if(entries, [](const auto& item) {
+                return item.second.use_count() == 1 && item.second->handle.expired();
+            });
+            auto& slot = entries[namespaceName];
+            if (!slot) {
+                slot = std::make_shared<SharedEntry>();
+            }
+            entry = slot;
+        }
+
+        // Held while opening, so concurrent first opens share one instance.
+        const std::scoped_lock lock(entry->mutex);
+        if (auto handle = entry->handle.lock()) {
+            handle->impl_->unlockRequested(options);
+            return handle;
+        }
+        std::shared_ptr<SafeKeeping> handle = open(std::move(namespaceName), options);
+        entry->handle = handle;
+        return handle;
+    }
+
+    // Lock every instance in the process. Returns how many were unlocked.
+    // The instances are pinned under instancesMutex() and locked after it is
+    // released, since lock() may commit a Deferred group, and creating or
+    // destroying instances elsewhere must not wait for that.
+    static std::size_t lockAll() {
+        std::vector<AsyncCall> unlocked;
+        {
+            const std::scoped_lock lock(instancesMutex());
+            for (auto* impl : instances()) {
+                if (impl->unlocked_) {
+                    unlocked.emplace_back(*impl);
+                }
+            }
+        }
+        for (const auto& call : unlocked) {
+            try {
+                call.impl().lock();
+            } catch (const std::exception&) {
+                // lock() drops the keys before reporting a failed final commit.
+            }
+        }
+        return unlocked.size();
+    }
+
+    // open()'s unlock attempts, reported through latestError(). Does nothing
+    // if no unlock method was requested.
+    void unlockRequested(const UnlockOptions& options) {
+        if (!options.trySystemVaultFirst && !options.passphrase.has_value() && !options.recoveryKey.has_value()) {
+            return;
+        }
+        clearLastError();
+        if (auto unlocked = unlock(options, {}); !unlocked) {
+            setLastError(unlocked.error().error, unlocked.error().message);
+        }
+    }
+
+    static bool exists(std::string_view namespaceName) {
+        if (storeLayout() == StoreLayout::Shared) {
+            validateNamespaceOrSecretName(namespaceName, "namespace");
+            return sharedStoreContains(namespaceName);
+        }
+        return std::filesystem::exists(databasePath(namespaceName));
+    }
+
+    // Fetch the vault material of many namespaces in one backend query and
+    // keep it in guarded memory for their next system-vault unlock.
+    static std::size_t prefetchVaultMaterial(std::span<const std::string> namespaceNames) {
+        for (const auto& namespaceName : namespaceNames) {
+            validateNamespaceOrSecretName(namespaceName, "namespace");
+        }
+        const auto vaultBackend = makeVaultBackend();
+        if (vaultBackend == nullptr || !vaultBackend->available()) {
+            return 0;
+        }
+        auto loaded = [&] {
+            const PhaseTimer timer(Phase::Vault);
+            return vaultBackend->loadMany(namespaceNames, kVaultEntryName);
+        }();
+        const std::scoped_lock lock(prefetchMutex());
+        for (auto& [namespaceName, material] : loaded) {
+            SecureBuffer buffer(material.size());
+            std::copy(material.begin(), material.end(), reinterpret_cast<char*>(buffer.data()));
+            sodium_memzero(material.data(), material.size());
+            prefetchedMaterial().insert_or_assign(namespaceName, std::move(buffer));
+        }
+        return loaded.size();
+    }
+
+    static void dropPrefetchedMaterial(std::string_view namespaceName) {
+        const std::scoped_lock lock(prefetchMutex());
+        if (const auto it = prefetchedMaterial().find(namespaceName); it != prefetchedMaterial().end()) {
+            prefetchedMaterial().erase(it);
+        }
+    }
+
+    static void clearPrefetchedMaterial() {
+        const std::scoped_lock lock(prefetchMutex());
+        prefetchedMaterial().clear();
+    }
+
+    static bool removeNamespace(std::string namespaceName) {
+        validateNamespaceOrSecretName(namespaceName, "namespace");
+        dropPrefetchedMaterial(namespaceName);
+        const bool shared = storeLayout() == StoreLayout::Shared;
+        const auto dbPath = databasePath(namespaceName);
+        const bool dbExists = shared ? removeFromSharedStore(namespaceName) : std::filesystem::exists(dbPath);
+        const auto vaultBackend = makeVaultBackend();
+        if (vaultBackend != nullptr && vaultBackend->available()) {
+            const PhaseTimer timer(Phase::Vault);
+            vaultBackend->remove(namespaceName, kVaultEntryName);
+        }
+        std::error_code error;
+        if (shared) {
+            // The namespace directory only holds its audit log.
+            std::filesystem::remove(dbPath.parent_path() / kAuditLogFileName, error);
+            std::error_code notEmpty;
+            std::filesystem::remove(dbPath.parent_path(), notEmpty);
+            return dbExists && !error;
+        }
+        std::filesystem::remove_all(dbPath.parent_path(), error);
+        return dbExists && !error;
+    }
+
+    const std::string& namespaceName() const noexcept {
+        return namespaceName_;
+    }
+
+    bool isUnlocked() const noexcept {
+        return unlocked_;
+    }
+
+    bool unlockWithSystemVault() {
+        if (unlocked_) {
+            return true;
+        }
+        auto dek = systemVaultDek();
+        setUnlockedDek(dek);
+        return true;
+    }
+
+    bool unlockWithPassphrase(std::string_view passphrase) {
+        if (unlocked_) {
+            return true;
+        }
+        auto dek = passphraseDek(passphrase);
+        setUnlockedDek(dek);
+        scheduleRewrap(kSlotTypePassphrase, std::string(passphrase));
+        return true;
+    }
+
+    bool unlockWithRecoveryKey(std::string_view recoveryKey) {
+        if (unlocked_) {
+            return true;
+        }
+        auto dek = recoveryKeyDek(recoveryKey);
+        setUnlockedDek(dek);
+        scheduleRewrap(kSlotTypeRecovery, normalizeRecoveryKey(recoveryKey));
+        return true;
+    }
+
+    // Try the unlock methods open() accepts on the KDF executor; the first
+    // DEK unwrapped wins. The system vault starts alone, and the passphrase
+    // and recovery key derivations join it only if it fails or takes longer
+    // than kVaultHeadStart, so a vault hit costs no Argon2 and a slow vault
+    // does not hold up the others for long. `stop` and an earlier win are
+    // checked before each method starts and before its key is installed: a
+    // key derivation that is already running cannot be interrupted, so a
+    // cancelled or losing result is wiped instead. Methods still running
+    // when this returns finish in the background; the destructor waits for
+    // them.
+    //
+    // If no method unlocks, reports the failure of the last one in open()'s
+    // order: system vault, passphrase, recovery key.
+    result_t<void> unlock(const UnlockOptions& options, const std::stop_token& stop) {
+        struct Method {
+            Operation operation;
+            std::function<bytes()> derive;
+        };
+        std::vector<Method> methods;
+        if (options.trySystemVaultFirst) {
+            methods.push_back({Operation::UnlockSystemVault, [this] {
+                                   return systemVaultDek();
+                               }});
+        }
+        if (options.passphrase.has_value()) {
+            methods.push_back({Operation::UnlockPassphrase, [this, passphrase = *options.passphrase] {
+                                   return passphraseDek(passphrase);
+                               }});
+        }
+        if (options.recoveryKey.has_value()) {
+            methods.push_back({Operation::UnlockRecoveryKey, [this, recoveryKey = *options.recoveryKey] {
+                                   return recoveryKeyDek(recoveryKey);
+                               }});
+        }
+        if (methods.empty()) {
+            return failure(Error::UnlockUnavailable, "no unlock method was requested");
+        }
+        if (unlocked_) {
+            return {};
+        }
+        if (stop.stop_requested()) {
+            return cancelledFailure();
+        }
+
+        struct Race {
+            std::mutex mutex;
+            std::condition_variable_any done;
+            std::size_t running = 0;
+            bool won = false;
+            std::vector<std::optional<ErrorInfo>> errors;
+        };
+        auto race = std::make_shared<Race>();
+        race->errors.resize(methods.size());
+
+        // Callers hold race->mutex.
+        std::size_t started = 0;
+        auto startUpTo = [&](std::size_t end) {
+            for (; started < end; ++started) {
+                ++race->running;
+                runKdfTask([race, i = started, stop, method = std::move(methods[started]), call = AsyncCall(*this)]() mutable {
+                    std::optional<result_t<bytes>> dek;
+                    {
+                        const std::scoped_lock lock(race->mutex);
+                        if (race->won || stop.stop_requested()) {
+                            race->errors[i] = cancelledFailure().error();
+                        }
+                    }
+                    if (!race->errors[i].has_value()) {
+                        dek = measured(call.impl(), method.operation, [&method] {
+                            return runResultOperation<bytes>(method.derive);
+                        });
+                    }
+
+                    const std::scoped_lock lock(race->mutex);
+                    if (dek.has_value() && dek->has_value()) {
+                        if (race->won || stop.stop_requested()) {
+                            sodium_memzero((*dek)->data(), (*dek)->size());
+                            race->errors[i] = cancelledFailure().error();
+                        } else {
+                            call.impl().setUnlockedDek(**dek);
+                            race->won = true;
+                        }
+                    } else if (dek.has_value()) {
+                        race->errors[i] = std::move(*dek).error();
+                    }
+                    --race->running;
+                    call.release();
+                    race->done.notify_all();
+                });
+            }
+        };
+        const auto finished = [&race] {
+            return race->won || race->running == 0;
+        };
+
+        std::unique_lock lock(race->mutex);
+        std::stop_token waitStop = stop;
+        if (options.trySystemVaultFirst) {
+            startUpTo(1);
+            race->done.wait_for(lock, waitStop, kVaultHeadStart, finished);
+        }
+        if (!race->won && !stop.stop_requested()) {
+            startUpTo(methods.size());
+        }
+        race->done.wait(lock, waitStop, finished);
+        if (race->won || unlocked_) {
+            lock.unlock();
+            if (options.passphrase.has_value()) {
+                scheduleRewrap(kSlotTypePassphrase, *options.passphrase);
+            }
+            if (options.recoveryKey.has_value()) {
+                scheduleRewrap(kSlotTypeRecovery, normalizeRecoveryKey(*options.recoveryKey));
+            }
+            return {};
+        }
+        if (stop.stop_requested()) {
+            return cancelledFailure();
+        }
+        return failure(std::move(*race->errors.back()));
+    }
+
+    // Rewrap a passphrase or recovery key slot with the limits from
+    // kdfOptions_ when it was created with others. Runs on the KDF executor
+    // after an unlock that was given the slot's secret. The secret is
+    // checked against the slot first, since a raced unlock may have been
+    // won by another method.
+    void scheduleRewrap(std::string_view slotType, std::string secret) {
+        if (!kdfOptions_.has_value() || readOnly_) {
+            sodium_memzero(secret.data(), secret.size());
+            return;
+        }
+        runKdfTask([call = AsyncCall(*this), slotType, secret = std::move(secret)]() mutable {
+            try {
+                call.impl().rewrapSlot(slotType, secret);
+            } catch (const std::exception&) {
+                // The slot keeps working with its old limits.
+            }
+            sodium_memzero(secret.data(), secret.size());
+        });
+    }
+
+    // Whether a slot derived with `slot`'s limits should be rewrapped for
+    // `target`. A calibrated target is remeasured in every process, so only
+    // a slot that is clearly cheaper than it is rewrapped; the fixed
+    // profiles are matched exactly, so a deployment can also lower them.
+    [[nodiscard]] bool needsRewrap(const SlotRecord& slot, const KdfParams& target) const {
+        const auto opslimit = static_cast<std::int64_t>(target.opslimit);
+        const auto memlimit = static_cast<std::int64_t>(target.memlimit);
+        if (kdfOptions_.has_value() && kdfOptions_->profile == KdfProfile::Calibrated) {
+            return slot.kdfMemlimit < memlimit || slot.kdfOpslimit < opslimit - opslimit / 4;
+        }
+        return slot.kdfOpslimit != opslimit || slot.kdfMemlimit != memlimit;
+    }
+
+    void rewrapSlot(std::string_view slotType, std::string_view secret) {
+        const auto target = kdfParams(kdfOptions_);
+        const auto slot = readSlot(slotType);
+        if (!slot.kdfSalt.has_value() || !needsRewrap(slot, target)) {
+            return;
+        }
+
+        auto dek = unwrapDek(slot,
+                             derivePassphraseKek(secret,
+                                                 *slot.kdfSalt,
+                                                 slot.kdfOpslimit,
+                                                 static_cast<std::size_t>(slot.kdfMemlimit)),
+                             "schema-1");
+        try {
+            const bytes salt = randomBytes(crypto_pwhash_SALTBYTES);
+            const auto kek = derivePassphraseKek(secret, salt, target.opslimit, target.memlimit);
+
+            const std::scoped_lock writeLock(writeMutex_);
+            // Leave the slot alone if it was replaced while deriving, or if
+            // the namespace was locked meanwhile.
+            if (unlocked_ && readSlot(slotType).kdfSalt == slot.kdfSalt) {
+                WriteScope txn(*this);
+                removeActiveSlot(statements_, slotType);
+                insertSlot(statements_, buildKdfSlot(slotType, dek, kek, salt, target));
+                updateMetadataTimestamp();
+                txn.commit();
+            }
+        } catch (...) {
+            sodium_memzero(dek.data(), dek.size());
+            throw;
+        }
+        sodium_memzero(dek.data(), dek.size());
+    }
+
+    [[nodiscard]] static Unexpected<ErrorInfo> cancelledFailure() {
+        return failure(Error::Cancelled, "operation was cancelled");
+    }
+
+    // Keeps the instance alive for a pending asynchronous call; the
+    // destructor waits until none are left.
+    class AsyncCall {
+    public:
+        explicit AsyncCall(Impl& impl) : impl_(&impl) {
+            const std::scoped_lock lock(impl_->asyncMutex_);
+            ++impl_->asyncPending_;
+        }
+
+        AsyncCall(AsyncCall&& other) noexcept : impl_(std::exchange(other.impl_, nullptr)) {}
+        AsyncCall(const AsyncCall&) = delete;
+        AsyncCall& operator=(const AsyncCall&) = delete;
+        AsyncCall& operator=(AsyncCall&&) = delete;
+
+        ~AsyncCall() {
+            release();
+        }
+
+        [[nodiscard]] Impl& impl() const noexcept {
+            return *impl_;
+        }
+
+        // Called before the caller is notified, so a completion callback may
+        // destroy the instance.
+        void release() noexcept {
+            if (impl_ == nullptr) {
+                return;
+            }
+            {
+                const std::scoped_lock lock(impl_->asyncMutex_);
+                --impl_->asyncPending_;
+            }
+            impl_->asyncIdle_.notify_all();
+            impl_ = nullptr;
+        }
+
+    private:
+        Impl* impl_;
+    };
+
+    // Unwrap the DEK through one unlock slot without unlocking the instance,
+    // so an asynchronous unlock can still drop it when it is cancelled.
+    [[nodiscard]] bytes systemVaultDek() const {
+        if (!hasSystemVaultSlot()) {
+            fail(Error::UnlockUnavailable, "system vault unlock slot is not configured");
+        }
+        if (auto prefetched = takePrefetchedMaterial(namespaceName_); prefetched.has_value()) {
+            try {
+                return unwrapDek(readSlot(kSlotTypeVault), deriveVaultKek(prefetched->view()), "schema-1");
+            } catch (const std::exception&) {
+                // Stale material; ask the vault below.
+            }
+        }
+        auto* const vaultBackend = this->vaultBackend();
+        if (vaultBackend == nullptr || !vaultBackend->available()) {
+            fail(Error::VaultError, "system vault backend is not available");
+        }
+
+        const auto material = [this, vaultBackend] {
+            const PhaseTimer timer(Phase::Vault);
+            return vaultBackend->load(namespaceName_, kVaultEntryName);
+        }();
+        if (!material.has_value()) {
+            const std::string detail = vaultBackend->lastErrorMessage();
+            fail(Error::VaultError,
+                 detail.empty() ? "failed to load namespace material from the system vault"
+                                : "failed to load namespace material from the system vault: " + detail);
+        }
+
+        try {
+            const auto slot = readSlot(kSlotTypeVault);
+            return unwrapDek(slot, deriveVaultKek(*material), "schema-1");
+        } catch (const OperationError&) {
+            throw;
+        } catch (const std::exception&) {
+            fail(Error::UnlockFailed, "system vault material did not unlock the namespace");
+        }
+    }
+
+    [[nodiscard]] bytes passphraseDek(std::string_view passphrase) const {
+        if (!hasPassphraseSlot()) {
+            fail(Error::UnlockUnavailable, "passphrase unlock slot is not configured");
+        }
+
+        try {
+            const auto slot = readSlot(kSlotTypePassphrase);
+            if (!slot.kdfSalt.has_value()) {
+                fail(Error::DataCorrupted, "passphrase slot is missing KDF salt");
+            }
+            return unwrapDek(slot,
+                             derivePassphraseKek(passphrase,
+                                                 *slot.kdfSalt,
+                                                 slot.kdfOpslimit,
+                                                 static_cast<std::size_t>(slot.kdfMemlimit)),
+                             "schema-1");
+        } catch (const OperationError&) {
+            throw;
+        } catch (const std::exception&) {
+            fail(Error::UnlockFailed, "passphrase did not unlock the namespace");
+        }
+    }
+
+    [[nodiscard]] bytes recoveryKeyDek(std::string_view recoveryKey) const {
+        if (!hasRecoverySlot()) {
+            fail(Error::UnlockUnavailable, "recovery key unlock slot is not configured");
+        }
+
+        try {
+            const auto slot = readSlot(kSlotTypeRecovery);
+            if (!slot.kdfSalt.has_value()) {
+                fail(Error::DataCorrupted, "recovery slot is missing KDF salt");
+            }
+            return unwrapDek(slot,
+                             derivePassphraseKek(normalizeRecoveryKey(recoveryKey),
+                                                 *slot.kdfSalt,
+                                                 slot.kdfOpslimit,
+                                                 static_cast<std::size_t>(slot.kdfMemlimit)),
+                             "schema-1");
+        } catch (const OperationError&) {
+            throw;
+        } catch (const std::exception&) {
+            fail(Error::UnlockFailed, "recovery key did not unlock the namespace");
+        }
+    }
+
+    bool lock() {
+        std::exception_ptr flushError;
+        try {
+            flush();
+        } catch (const std::exception&) {
+            flushError = std::current_exception();
+        }
+        if (audit_ != nullptr) {
+            // The audit key goes with the keys below.
+            audit_->flush();
+        }
+
+        {
+            const std::unique_lock keysLock(keyMutex_);
+            keys_.reset();
+            unlocked_ = false;
+        }
+        cache_.clear();
+        {
+            const std::scoped_lock writeLock(writeMutex_);
+            statements_.clear();
+        }
+        closeReaders();
+        if (flushError) {
+            std::rethrow_exception(flushError);
+        }
+        return true;
+    }
+
+    bool flush() {
+        const std::scoped_lock writeLock(writeMutex_);
+        commitGroup();
+        reportGroupError();
+        return true;
+    }
+
+    result_t<void> storeSecret(std::string_view name,
+                               byte_view secret,
+                               std::optional<std::string_view> description = std::nullopt) {
+        if (auto error = checkWritable()) {
+            return failure(std::move(*error));
+        }
+        const auto keys = currentKeys();
+        if (!keys) {
+            return lockedFailure();
+        }
+        if (auto error = checkSecretWrite(name, secret, description)) {
+            return failure(std::move(*error));
+        }
+        const auto record = encryptSecret(*keys, name, secret, description);
+
+        const std::scoped_lock writeLock(writeMutex_);
+        WriteScope txn(*this);
+        upsertSecret(record, nowSeconds());
+        updateMetadataTimestamp();
+        txn.commit();
+        cache_.invalidate(record.nameHash);
+        lockDownDatabaseArtifacts(dbPath_);
+        return {};
+    }
+
+    bool applyBatch(const WriteBatch::operations_t& operations) {
+        requireWritable();
+        const auto keys = unlockedKeys();
+        for (const auto& operation : operations) {
+            if (operation.remove) {
+                validateNamespaceOrSecretName(operation.name, "secret name");
+            } else {
+                validateSecretWrite(operation.name, operation.value, operation.descriptionView());
+            }
+        }
+        if (operations.empty()) {
+            return true;
+        }
+
+        // Encrypt everything up front so the write transaction only does SQL.
+        std::vector<SecretRecord> records;
+        records.reserve(operations.size());
+        for (const auto& operation : operations) {
+            if (operation.remove) {
+                const auto nameHash = keys->nameHash(operation.name);
+                SecretRecord removal;
+                removal.nameHash.assign(nameHash.begin(), nameHash.end());
+                records.push_back(std::move(removal));
+            } else {
+                records.push_back(encryptSecret(*keys, operation.name,
+                                                operation.value,
+                                                operation.descriptionView()));
+            }
+        }
+
+        const std::scoped_lock writeLock(writeMutex_);
+        const auto now = nowSeconds();
+        WriteScope txn(*this);
+        for (std::size_t i = 0; i < operations.size(); ++i) {
+            if (!operations[i].remove) {
+                upsertSecret(records[i], now);
+            } else if (!deleteSecret(records[i].nameHash)) {
+                fail(Error::NotFound, "secret was not found: " + operations[i].name);
+            }
+        }
+        updateMetadataTimestamp();
+        txn.commit();
+        for (const auto& record : records) {
+            cache_.invalidate(record.nameHash);
+        }
+        lockDownDatabaseArtifacts(dbPath_);
+        return true;
+    }
+
+    // Every single-secret read goes through here. `allocate(size)` returns
+    // the buffer for a value of `size` bytes, and the value is copied from
+    // the cache or decrypted from the row into it exactly once.
+    template <typename Allocate>
+    result_t<std::size_t> retrieveSecretWith(std::string_view name, Allocate&& allocate) const {
+        // Read the generation before taking the keys, so a lock() that
+        // clears the cache after this point also rejects the insert below.
+        const auto generation = cache_.generation();
+        const auto keys = currentKeys();
+        if (!keys) {
+            return lockedFailure();
+        }
+        if (auto error = checkName(name, "secret name")) {
+            return failure(std::move(*error));
+        }
+        const name_hash_t nameHash = keys->nameHash(name);
+        if (auto cached = cache_.lookup(nameHash, allocate)) {
+            return std::move(*cached);
+        }
+
+        const ReadAccess connection(*this);
+        auto stmt = connection.statements().acquire(StatementId::SelectSecret);
+        bindBlob(stmt.get(), 1, nameHash);
+        if (stepStatement(stmt.get()) != SQLITE_ROW) {
+            return failure(Error::NotFound, "secret was not found");
+        }
+
+        std::optional<StreamManifest> manifest;
+        std::size_t size = 0;
+        if (sqlite3_column_type(stmt.get(), 4) == SQLITE_NULL) {
+            verifySecretName(*keys, stmt.get(), 0, name, nameHash);
+            size = sealedValueSize(stmt.get(), 0);
+        } else {
+            manifest = decryptStoredValue(*keys, stmt.get(), 0, name, nameHash).manifest;
+            if (manifest->totalSize > std::numeric_limits<std::size_t>::max()) {
+                return failure(Error::TooLarge, "secret is too large for this platform");
+            }
+            size = static_cast<std::size_t>(manifest->totalSize);
+        }
+
+        auto target = allocate(size);
+        if (!target) {
+            return Unexpected(std::move(target).error());
+        }
+        try {
+            if (manifest.has_value()) {
+                readChunksInto(*keys, connection.statements(), *manifest, *target);
+            } else {
+                decryptSecretValueInto(*keys, stmt.get(), 0, nameHash, *target);
+            }
+        } catch (...) {
+            sodium_memzero(target->data(), target->size());
+            throw;
+        }
+        cache_.insert(nameHash, *target, generation);
+        return size;
+    }
+
+    result_t<std::vector<std::byte>> retrieveSecretBytes(std::string_view name) const {
+        std::vector<std::byte> value;
+        auto size = retrieveSecretWith(name, [&value](std::size_t size) -> result_t<std::span<std::byte>> {
+            if (size > kMaxSecretSize) {
+                return failure(Error::TooLarge, "secret is larger than 10240 bytes; read it with openSecretReader()");
+            }
+            value.resize(size);
+            return std::span(value);
+        });
+        if (!size) {
+            return Unexpected(std::move(size).error());
+        }
+        return value;
+    }
+
+    result_t<std::string> retrieveSecret(std::string_view name) const {
+        std::string value;
+        auto size = retrieveSecretWith(name, [&value](std::size_t size) -> result_t<std::span<std::byte>> {
+            if (size > kMaxSecretSize) {
+                return failure(Error::TooLarge, "secret is larger than 10240 bytes; read it with openSecretReader()");
+            }
+            value.resize(size);
+            return std::as_writable_bytes(std::span(value));
+        });
+        if (!size) {
+            return Unexpected(std::move(size).error());
+        }
+        return value;
+    }
+
+    result_t<std::size_t> retrieveSecretInto(std::string_view name, std::span<std::byte> out) const {
+        return retrieveSecretWith(name, [out](std::size_t size) -> result_t<std::span<std::byte>> {
+            if (size > out.size()) {
+                return failure(Error::TooLarge,
+                               "output buffer is too small; the secret is " + std::to_string(size) + " bytes");
+            }
+            return out.first(size);
+        });
+    }
+
+    result_t<SecureBuffer> retrieveSecretSecure(std::string_view name) const {
+        SecureBuffer value;
+        auto size = retrieveSecretWith(name, [&value](std::size_t size) -> result_t<std::span<std::byte>> {
+            value = SecureBuffer(size);
+            return value.span();
+        });
+        if (!size) {
+            return Unexpected(std::move(size).error());
+        }
+        return value;
+    }
+
+    std::optional<lookup_list_t> retrieveSecrets(std::span<const std::string_view> names) const {
+        const auto keys = unlockedKeys();
+
+        lookup_list_t results(names.size());
+        std::map<name_hash_t, std::vector<std::size_t>> pending;
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            results[i].name = toString(names[i]);
+            if (const auto error = checkName(names[i], "secret name")) {
+                results[i].error = error->error;
+                continue;
+            }
+            results[i].error = Error::NotFound;
+            pending[keys->nameHash(names[i])].push_back(i);
+        }
+
+        // One statement step sequence per kLookupBatchSize distinct names.
+        // Unused placeholders stay NULL and match nothing.
+        const ReadAccess connection(*this);
+        auto next = pending.begin();
+        while (next != pending.end()) {
+            auto stmt = connection.statements().acquire(StatementId::SelectSecretsBatch);
+            for (int param = 1; param <= static_cast<int>(kLookupBatchSize) && next != pending.end();
+                 ++param, ++next) {
+                bindBlob(stmt.get(), param, next->first);
+            }
+
+            int rc = SQLITE_ROW;
+            while ((rc = stepStatement(stmt.get())) == SQLITE_ROW) {
+                const bytes rowHash = columnBlob(stmt.get(), 0);
+                if (rowHash.size() != crypto_generichash_BYTES) {
+                    continue;
+                }
+                name_hash_t nameHash{};
+                std::copy(rowHash.begin(), rowHash.end(), nameHash.begin());
+                const auto match = pending.find(nameHash);
+                if (match == pending.end()) {
+                    continue;
+                }
+
+                auto& first = results[match->second.front()];
+                try {
+                    first.value = readStoredValue(
+                        *keys,
+                        connection.statements(),
+                        decryptStoredValue(*keys, stmt.get(), 1, first.name, nameHash));
+                    first.error = Error::None;
+                } catch (const OperationError& error) {
+                    first.error = error.error();
+                } catch (const std::exception&) {
+                    first.error = Error::StorageError;
+                }
+                for (std::size_t j = 1; j < match->second.size(); ++j) {
+                    auto& duplicate = results[match->second[j]];
+                    duplicate.value = first.value;
+                    duplicate.error = first.error;
+                }
+            }
+            if (rc != SQLITE_DONE) {
+                throw std::runtime_error(sqlite3_errmsg(connection.db()));
+            }
+        }
+        return results;
+    }
+
+    result_t<void> removeSecret(std::string_view name) {
+        if (auto error = checkWritable()) {
+            return failure(std::move(*error));
+        }
+        const auto keys = currentKeys();
+        if (!keys) {
+            return lockedFailure();
+        }
+        if (auto error = checkName(name, "secret name")) {
+            return failure(std::move(*error));
+        }
+        const auto nameHash = keys->nameHash(name);
+        const std::scoped_lock writeLock(writeMutex_);
+        WriteScope txn(*this);
+        if (!deleteSecret(nameHash)) {
+            return failure(Error::NotFound, "secret was not found");
+        }
+        updateMetadataTimestamp();
+        txn.commit();
+        cache_.invalidate(nameHash);
+        return {};
+    }
+
+    info_list_t listSecrets() const {
+        const auto keys = unlockedKeys();
+        info_list_t list;
+        scanSecrets(*keys, {}, -1, true, [&list](const bytes&, Info&& info) {
+            list.push_back(std::move(info));
+            return true;
+        });
+
+        std::sort(list.begin(), list.end(), [](const Info& lhs, const Info& rhs) {
+            return lhs.name < rhs.name;
+        });
+        return list;
+    }
+
+    bool forEachSecret(const ListOptions& options, const list_visitor_t& visitor) const {
+        const auto keys = unlockedKeys();
+        if (!visitor) {
+            fail(Error::InvalidArgument, "list visitor is empty");
+        }
+        const auto after = decodeListCursor(options.cursor);
+        scanSecrets(*keys, after, sqlLimit(options.limit), options.includeDescriptions, [&visitor](const bytes&, Info&& info) {
+            return visitor(info);
+        });
+        return true;
+    }
+
+    ListPage listSecretsPage(const ListOptions& options) const {
+        const auto keys = unlockedKeys();
+        const auto after = decodeListCursor(options.cursor);
+
+        // Fetch one row past the page so the last page carries no cursor.
+        ListPage page;
+        bytes lastHash;
+        bool more = false;
+        const auto limit = options.limit == 0 ? -1 : sqlLimit(options.limit) + 1;
+        scanSecrets(*keys, after, limit, options.includeDescriptions, [&](const bytes& nameHash, Info&& info) {
+            if (options.limit != 0 && page.entries.size() == options.limit) {
+                more = true;
+                return false;
+            }
+            lastHash = nameHash;
+            page.entries.push_back(std::move(info));
+            return true;
+        });
+        if (more) {
+            page.nextCursor = bytesToHex(lastHash);
+        }
+        return page;
+    }
+
+    // Streaming writes. Full chunks are stored as they fill; the last chunk
+    // and the secrets row pointing at the stream are written together by
+    // commitStream(), so the new value replaces the old one atomically.
+    [[nodiscard]] StreamManifest beginStream(std::string_view name,
+                                             const std::optional<std::string_view>& description) const {
+        requireWritable();
+        (void)unlockedKeys();
+        validateNamespaceOrSecretName(name, "secret name");
+        if (description.has_value()) {
+            if (auto error = checkDescription(*description)) {
+                fail(error->error, std::move(error->message));
+            }
+        }
+
+        StreamManifest manifest;
+        randombytes_buf(manifest.streamId.data(), manifest.streamId.size());
+        manifest.chunkSize = static_cast<std::uint32_t>(kStreamChunkSize);
+        return manifest;
+    }
+
+    // Store full chunk `index`. The manifest's chunkCount is not final yet,
+    // so it must be larger than `index` to seal this as a non-last chunk.
+    void writeStreamChunk(const StreamManifest& manifest,
+                          std::uint64_t index,
+                          std::span<const unsigned char> plaintext) {
+        const auto keys = unlockedKeys();
+        const std::scoped_lock writeLock(writeMutex_);
+        WriteScope txn(*this);
+        insertChunk(manifest, index, plaintext, *keys);
+        txn.commit();
+    }
+
+    void commitStream(std::string_view name,
+                      const std::optional<std::string_view>& description,
+                      const StreamManifest& manifest,
+                      std::span<const unsigned char> lastChunk) {
+        const auto keys = unlockedKeys();
+        const auto encoded = manifest.encode();
+        auto record = encryptSecret(*keys, name, std::as_bytes(std::span(encoded)), description);
+        record.streamId = bytes(manifest.streamId.begin(), manifest.streamId.end());
+
+        const std::scoped_lock writeLock(writeMutex_);
+        WriteScope txn(*this);
+        insertChunk(manifest, manifest.chunkCount - 1, lastChunk, *keys);
+        upsertSecret(record, nowSeconds());
+        updateMetadataTimestamp();
+        txn.commit();
+        cache_.invalidate(record.nameHash);
+        lockDownDatabaseArtifacts(dbPath_);
+    }
+
+    void discardStream(const StreamManifest& manifest) {
+        const std::scoped_lock writeLock(writeMutex_);
+        WriteScope txn(*this);
+        auto stmt = statements_.acquire(StatementId::DeleteStreamChunks);
+        bindBlob(stmt.get(), 1, manifest.streamId);
+        stepDone(db_.get(), stmt.get());
+        txn.commit();
+    }
+
+    [[nodiscard]] StoredValue openStream(std::string_view name) const {
+        const auto keys = unlockedKeys();
+        validateNamespaceOrSecretName(name, "secret name");
+        const name_hash_t nameHash = keys->nameHash(name);
+
+        const ReadAccess connection(*this);
+        auto stmt = connection.statements().acquire(StatementId::SelectSecret);
+        bindBlob(stmt.get(), 1, nameHash);
+        if (stepStatement(stmt.get()) != SQLITE_ROW) {
+            fail(Error::NotFound, "secret was not found");
+        }
+        return decryptStoredValue(*keys, stmt.get(), 0, name, nameHash);
+    }
+
+    [[nodiscard]] bytes readStreamChunk(const StreamManifest& manifest, std::uint64_t index) const {
+        const auto keys = unlockedKeys();
+        const ReadAccess connection(*this);
+        return loadChunk(*keys, connection.statements(), manifest, index);
+    }
+
+    void enableCache(const CacheOptions& options) {
+        cache_.configure(options);
+    }
+
+    void disableCache() {
+        cache_.disable();
+    }
+
+    [[nodiscard]] CacheStats cacheStats() const {
+        return cache_.stats();
+    }
+
+    [[nodiscard]] Metrics& metrics() const noexcept {
+        return metrics_;
+    }
+
+    // SafeKeepingManager support. `hook` runs when the instance uses its
+    // connections again after closeConnections().
+    void manage(std::function<void()> hook) {
+        {
+            const std::scoped_lock lock(hookMutex_);
+            reopenHook_ = std::move(hook);
+        }
+        lastUse_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        managed_.store(true, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool connectionsOpen() const noexcept {
+        return !closed_.load(std::memory_order_relaxed);
+    }
+
+    // Whether closeConnections() has run, as opposed to an instance that
+    // open() left unconnected.
+    [[nodiscard]] bool evicted() const noexcept {
+        return evicted_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::int64_t lastUse() const noexcept {
+        return lastUse_.load(std::memory_order_relaxed);
+    }
+
+    // Close the writer and the idle read connections unless a write or a
+    // Deferred group is in progress; reads in flight close theirs when done.
+    // The next call reopens them. Keys stay unless `lockKeys` is set.
+    bool closeConnections(bool lockKeys) {
+        const std::unique_lock writeLock(writeMutex_, std::try_to_lock);
+        if (!writeLock.owns_lock() || groupOpen_) {
+            return false;
+        }
+        if (lockKeys && unlocked_) {
+            try {
+                lock();
+            } catch (const std::exception&) {
+                // The keys are gone either way; the group was not pending.
+            }
+        }
+        statements_.clear();
+        db_.reset();
+        // Before clearing, so a reader that leases after the clear sees it.
+        evicted_.store(true, std::memory_order_relaxed);
+        closed_.store(true);
+        closeReaders();
+        return true;
+    }
+
+    void audit(Operation operation, std::string_view name, Error outcome) const {
+        if (audit_ != nullptr) {
+            audit_->record(operation, name, outcome);
+        }
+    }
+
+    [[nodiscard]] AuditStats auditStats() const {
+        return audit_ != nullptr ? audit_->stats() : AuditStats{};
+    }
+
+    [[nodiscard]] std::vector<AuditEvent> readAuditLog() const {
+        const auto keys = unlockedKeys();
+        if (audit_ == nullptr) {
+            fail(Error::NotFound, "audit log is not enabled for this instance");
+        }
+        audit_->flush();
+        return audit_->read(*keys);
+    }
+
+    [[nodiscard]] Stats stats() const {
+        auto stats = metrics_.snapshot();
+        addSqliteStatus(stats);
+        return stats;
+    }
+
+    // Operations of every instance, with the page cache counters of those
+    // still open. A read pool shared by several instances is counted once.
+    [[nodiscard]] static Stats processStats() {
+        auto stats = processMetrics().snapshot();
+        const std::scoped_lock lock(instancesMutex());
+        std::set<const ReadConnectionPool*> pools;
+        for (const auto* impl : instances()) {
+            impl->addWriterStatus(stats);
+            if (pools.insert(impl->readers_.get()).second) {
+                impl->addReaderStatus(stats);
+            }
+        }
+        return stats;
+    }
+
+    void setScanWorkers(std::size_t workers) {
+        const std::scoped_lock lock(scanPoolMutex_);
+        scanWorkers_ = workers;
+        scanPool_.reset();
+    }
+
+    bool hasSystemVaultSlot() const {
+        const ReadAccess connection(*this);
+        return hasSlot(connection.statements(), kSlotTypeVault);
+    }
+
+    bool hasPassphraseSlot() const {
+        const ReadAccess connection(*this);
+        return hasSlot(connection.statements(), kSlotTypePassphrase);
+    }
+
+    bool hasRecoverySlot() const {
+        const ReadAccess connection(*this);
+        return hasSlot(connection.statements(), kSlotTypeRecovery);
+    }
+
+    std::vector<UnlockMethod> availableUnlockMethods() const {
+        const ReadAccess connection(*this);
+        return listUnlockMethods(connection.statements());
+    }
+
+    bool addSystemVaultSlot() {
+        requireWritable();
+        const auto keys = unlockedKeys();
+        const std::scoped_lock writeLock(writeMutex_);
+        if (hasSystemVaultSlot()) {
+            fail(Error::AlreadyExists, "system vault slot already exists");
+        }
+        auto* const vaultBackend = this->vaultBackend();
+        if (vaultBackend == nullptr || !vaultBackend->available()) {
+            fail(Error::VaultError, "system vault backend is not available");
+        }
+
+        const std::string material = bytesToHex(randomBytes(32));
+        dropPrefetchedMaterial(namespaceName_);
+        const bool stored = [&] {
+            const PhaseTimer timer(Phase::Vault);
+            return vaultBackend->store(namespaceName_, kVaultEntryName, material);
+        }();
+        if (!stored) {
+            const std::string detail = vaultBackend->lastErrorMessage();
+            fail(Error::VaultError,
+                 detail.empty() ? "failed to store namespace material in the system vault"
+                                : "failed to store namespace material in the system vault: " + detail);
+        }
+
+        WriteScope txn(*this);
+        insertSlot(statements_,
+                   buildWrappedSlot("vault",
+                                    "vault",
+                                    keys->dek(),
+                                    deriveVaultKek(material),
+                                    std::nullopt,
+                                    std::nullopt,
+                                    0,
+                                    0));
+        updateMetadataTimestamp();
+        txn.commit();
+        return true;
+    }
+
+    bool addPassphrase(std::string_view passphrase) {
+        requireWritable();
+        const auto keys = unlockedKeys();
+        if (hasPassphraseSlot()) {
+            fail(Error::AlreadyExists, "passphrase slot already exists");
+        }
+
+        // Derive before taking the write lock, so Argon2 does not stall
+        // other writers, then check again under the lock.
+        const auto kdf = kdfParams(kdfOptions_);
+        const bytes salt = randomBytes(crypto_pwhash_SALTBYTES);
+        const auto kek = derivePassphraseKek(passphrase, salt, kdf.opslimit, kdf.memlimit);
+        const std::scoped_lock writeLock(writeMutex_);
+        if (hasPassphraseSlot()) {
+            fail(Error::AlreadyExists, "passphrase slot already exists");
+        }
+        WriteScope txn(*this);
+        insertSlot(statements_, buildKdfSlot(kSlotTypePassphrase, keys->dek(), kek, salt, kdf));
+        updateMetadataTimestamp();
+        txn.commit();
+        return true;
+    }
+
+    bool changePassphrase(std::string_view newPassphrase) {
+        requireWritable();
+        const auto keys = unlockedKeys();
+        if (!hasPassphraseSlot()) {
+            fail(Error::NotFound, "passphrase slot does not exist");
+        }
+
+        const auto kdf = kdfParams(kdfOptions_);
+        const bytes salt = randomBytes(crypto_pwhash_SALTBYTES);
+        const auto kek = derivePassphraseKek(newPassphrase, salt, kdf.opslimit, kdf.memlimit);
+        const std::scoped_lock writeLock(writeMutex_);
+        if (!hasPassphraseSlot()) {
+            fail(Error::NotFound, "passphrase slot does not exist");
+        }
+        WriteScope txn(*this);
+        removeActiveSlot(statements_, kSlotTypePassphrase);
+        insertSlot(statements_, buildKdfSlot(kSlotTypePassphrase, keys->dek(), kek, salt, kdf));
+        updateMetadataTimestamp();
+        txn.commit();
+        return true;
+    }
+
+    bool removePassphrase() {
+        requireWritable();
+        const auto keys = unlockedKeys();
+        const std::scoped_lock writeLock(writeMutex_);
+        if (!hasPassphraseSlot()) {
+            fail(Error::NotFound, "passphrase slot does not exist");
+        }
+        if (activeSlotCount(writer()) <= 1) {
+            fail(Error::InvalidArgument, "cannot remove the last unlock method");
+        }
+
+        WriteScope txn(*this);
+        removeActiveSlot(statements_, kSlotTypePassphrase);
+        updateMetadataTimestamp();
+        txn.commit();
+        return true;
+    }
+
+    std::optional<std::string> rotateRecoveryKey() {
+        requireWritable();
+        const auto keys = unlockedKeys();
+
+        // Derive before taking the write lock, so Argon2 runs in parallel
+        // with other writers instead of stalling them.
+        auto [formattedKey, rawRecovery] = generateRecoverySecret();
+        const auto kdf = kdfParams(kdfOptions_);
+        const bytes salt = randomBytes(crypto_pwhash_SALTBYTES);
+        const auto kek = derivePassphraseKek(normalizeRecoveryKey(formattedKey), salt, kdf.opslimit, kdf.memlimit);
+        sodium_memzero(rawRecovery.data(), rawRecovery.size());
+
+        const std::scoped_lock writeLock(writeMutex_);
+        if (!hasRecoverySlot() && activeSlotCount(writer()) == 0) {
+            fail(Error::InvalidArgument, "cannot rotate recovery key without an active unlock method");
+        }
+        WriteScope txn(*this);
+        removeActiveSlot(statements_, kSlotTypeRecovery);
+        insertSlot(statements_, buildKdfSlot(kSlotTypeRecovery, keys->dek(), kek, salt, kdf));
+        updateMetadataTimestamp();
+        txn.commit();
+        return formattedKey;
+    }
+
+    bool removeRecoveryKey() {
+        requireWritable();
+        const auto keys = unlockedKeys();
+        const std::scoped_lock writeLock(writeMutex_);
+        if (!hasRecoverySlot()) {
+            fail(Error::NotFound, "recovery slot does not exist");
+        }
+        if (activeSlotCount(writer()) <= 1) {
+            fail(Error::InvalidArgument, "cannot remove the last unlock method");
+        }
+
+        WriteScope txn(*this);
+        removeActiveSlot(statements_, kSlotTypeRecovery);
+        updateMetadataTimestamp();
+        txn.commit();
+        return true;
+    }
+
+    // Errors are tracked per calling thread, so concurrent callers only see
+    // the outcome of their own last operation. They live in thread-local
+    // storage keyed by instance serial: an exiting thread takes its entries
+    // with it, and neither a reused thread id nor a reused instance address
+    // can see an old error. Entries of destroyed instances are dropped on
+    // the thread's next call into any instance, so the map stays bounded by
+    // the live instances.
+    void clearLastError() const {
+        auto& local = pruneThreadErrors();
+        local.errors.erase(serial_);
+    }
+
+    void setLastError(Error error, std::string message) const {
+        auto& local = pruneThreadErrors();
+        local.errors[serial_] = {.error = error, .message = std::move(message)};
+    }
+
+    [[nodiscard]] LatestError latestError() const {
+        const auto& errors = threadErrors().errors;
+        const auto it = errors.find(serial_);
+        return it == errors.end() ? LatestError{} : it->second;
+    }
+
+private:
+
+    [[nodiscard]] static std::optional<ErrorInfo> checkSecretWrite(
+        std::string_view name,
+        byte_view secret,
+        const std::optional<std::string_view>& description) {
+        if (auto error = checkName(name, "secret name")) {
+            return error;
+        }
+        if (auto error = checkSecretValue(secret)) {
+            return error;
+        }
+        if (description.has_value()) {
+            return checkDescription(*description);
+        }
+        return std::nullopt;
+    }
+
+    static void validateSecretWrite(std::string_view name,
+                                    byte_view secret,
+                                    const std::optional<std::string_view>& description) {
+        if (auto error = checkSecretWrite(name, secret, description)) {
+            fail(error->error, std::move(error->message));
+        }
+    }
+
+    [[nodiscard]] static Unexpected<ErrorInfo> failure(ErrorInfo error) {
+        return Unexpected<ErrorInfo>(std::move(error));
+    }
+
+    [[nodiscard]] static Unexpected<ErrorInfo> failure(Error error, std::string message) {
+        return failure({.error = error, .message = std::move(message)});
+    }
+
+    [[nodiscard]] static SecretRecord encryptSecret(const KeySchedule& keys,
+                                                    std::string_view name,
+                                                    byte_view secret,
+                                                    const std::optional<std::string_view>& description) {
+        const name_hash_t nameHash = keys.nameHash(name);
+        SecretRecord record;
+        record.nameHash.assign(nameHash.begin(), nameHash.end());
+        record.nameCiphertext = aeadEncrypt(toBytes(name),
+                                            keys.dek(),
+                                            SecretAad(kAadSecretName, nameHash).view(),
+                                            record.nameNonce);
+        record.valueCiphertext = aeadEncrypt(toBytes(secret),
+                                             keys.dek(),
+                                             SecretAad(kAadSecretValue, nameHash).view(),
+                                             record.valueNonce);
+        if (description.has_value()) {
+            bytes nonce;
+            record.descriptionCiphertext = aeadEncrypt(
+                toBytes(*description),
+                keys.dek(),
+                SecretAad(kAadSecretDescription, nameHash).view(),
+                nonce);
+            record.descriptionNonce = std::move(nonce);
+        }
+        return record;
+    }
+
+    // Replaces any earlier value, including the chunks of a streamed one.
+    void upsertSecret(const SecretRecord& record, std::int64_t now) {
+        deleteSecretChunks(record.nameHash);
+        auto stmt = statements_.acquire(StatementId::UpsertSecret);
+        bindBlob(stmt.get(), 1, record.nameHash);
+        bindBlob(stmt.get(), 2, record.nameNonce);
+        bindBlob(stmt.get(), 3, record.nameCiphertext);
+        bindBlob(stmt.get(), 4, record.valueNonce);
+        bindBlob(stmt.get(), 5, record.valueCiphertext);
+        bindOptionalBlob(stmt.get(), 6, record.descriptionNonce);
+        bindOptionalBlob(stmt.get(), 7, record.descriptionCiphertext);
+        bindInt64(stmt.get(), 8, now);
+        bindInt64(stmt.get(), 9, now);
+        bindOptionalBlob(stmt.get(), 10, record.streamId);
+        stepDone(db_.get(), stmt.get());
+    }
+
+    void deleteSecretChunks(std::span<const unsigned char> nameHash) {
+        auto stmt = statements_.acquire(StatementId::DeleteSecretChunks);
+        bindBlob(stmt.get(), 1, nameHash);
+        stepDone(db_.get(), stmt.get());
+    }
+
+    // Returns false if no secret with that name hash exists.
+    bool deleteSecret(std::span<const unsigned char> nameHash) {
+        deleteSecretChunks(nameHash);
+        auto stmt = statements_.acquire(StatementId::DeleteSecret);
+        bindBlob(stmt.get(), 1, nameHash);
+        stepDone(db_.get(), stmt.get());
+        return sqlite3_changes(db_.get()) > 0;
+    }
+
+    // Secrets rows carry name nonce, name, value nonce and value from
+    // `firstColumn` on. The helpers below decrypt them straight from the
+    // column blobs.
+    static void verifySecretName(const KeySchedule& keys,
+                                 sqlite3_stmt* stmt,
+                                 int firstColumn,
+                                 std::string_view name,
+                                 const name_hash_t& nameHash) {
+        const auto ciphertext = columnView(stmt, firstColumn + 1);
+        bytes decryptedName(openedSize(ciphertext));
+        aeadDecryptInto(ciphertext,
+                        columnView(stmt, firstColumn),
+                        keys.dek(),
+                        SecretAad(kAadSecretName, nameHash).view(),
+                        decryptedName);
+        if (std::string_view(reinterpret_cast<const char*>(decryptedName.data()), decryptedName.size()) != name) {
+            fail(Error::DataCorrupted, "secret name payload is corrupted");
+        }
+    }
+
+    [[nodiscard]] static std::size_t sealedValueSize(sqlite3_stmt* stmt, int firstColumn) {
+        return openedSize(columnView(stmt, firstColumn + 3));
+    }
+
+    // `out` must be sealedValueSize() bytes.
+    static void decryptSecretValueInto(const KeySchedule& keys,
+                                       sqlite3_stmt* stmt,
+                                       int firstColumn,
+                                       const name_hash_t& nameHash,
+                                       std::span<std::byte> out) {
+        aeadDecryptInto(columnView(stmt, firstColumn + 3),
+                        columnView(stmt, firstColumn + 2),
+                        keys.dek(),
+                        SecretAad(kAadSecretValue, nameHash).view(),
+                        asWritableUnsigned(out));
+    }
+
+    [[nodiscard]] static std::vector<std::byte> decryptSecretValue(const KeySchedule& keys,
+                                                                   sqlite3_stmt* stmt,
+                                                                   int firstColumn,
+                                                                   std::string_view name,
+                                                                   const name_hash_t& nameHash) {
+        verifySecretName(keys, stmt, firstColumn, name, nameHash);
+        std::vector<std::byte> value(sealedValueSize(stmt, firstColumn));
+        decryptSecretValueInto(keys, stmt, firstColumn, nameHash, value);
+        return value;
+    }
+
+    // decryptSecretValue() plus the stream_id column after the value columns.
+    [[nodiscard]] static StoredValue decryptStoredValue(const KeySchedule& keys,
+                                                        sqlite3_stmt* stmt,
+                                                        int firstColumn,
+                                                        std::string_view name,
+                                                        const name_hash_t& nameHash) {
+        StoredValue stored{.value = decryptSecretValue(keys, stmt, firstColumn, name, nameHash),
+                           .manifest = std::nullopt};
+        const auto streamId = columnOptionalBlob(stmt, firstColumn + 4);
+        if (!streamId.has_value()) {
+            return stored;
+        }
+
+        stored.manifest = StreamManifest::decode(stored.value);
+        if (!std::equal(streamId->begin(), streamId->end(),
+                        stored.manifest->streamId.begin(), stored.manifest->streamId.end())) {
+            fail(Error::DataCorrupted, "secret stream id does not match its manifest");
+        }
+        stored.value.clear();
+        return stored;
+    }
+
+    // The whole value of a row, reading the chunks of a streamed secret.
+    // Streamed values above kMaxSecretSize are only readable through a
+    // SecretReader.
+    [[nodiscard]] static std::vector<std::byte> readStoredValue(const KeySchedule& keys,
+                                                                StatementCache& statements,
+                                                                StoredValue&& stored) {
+        if (!stored.manifest.has_value()) {
+            return std::move(stored.value);
+        }
+        const auto& manifest = *stored.manifest;
+        if (manifest.totalSize > kMaxSecretSize) {
+            fail(Error::TooLarge, "secret is larger than 10240 bytes; read it with openSecretReader()");
+        }
+
+        std::vector<std::byte> value(static_cast<std::size_t>(manifest.totalSize));
+        try {
+            readChunksInto(keys, statements, manifest, value);
+        } catch (...) {
+            sodium_memzero(value.data(), value.size());
+            throw;
+        }
+        return value;
+    }
+
+    // `out` must be manifest.totalSize bytes.
+    static void readChunksInto(const KeySchedule& keys,
+                               StatementCache& statements,
+                               const StreamManifest& manifest,
+                               std::span<std::byte> out) {
+        for (std::uint64_t index = 0; index < manifest.chunkCount; ++index) {
+            loadChunkInto(keys,
+                          statements,
+                          manifest,
+                          index,
+                          asWritableUnsigned(out.subspan(static_cast<std::size_t>(index * manifest.chunkSize),
+                                                         manifest.chunkLength(index))));
+        }
+    }
+
+    // `out` must be manifest.chunkLength(index) bytes.
+    static void loadChunkInto(const KeySchedule& keys,
+                              StatementCache& statements,
+                              const StreamManifest& manifest,
+                              std::uint64_t index,
+                              std::span<unsigned char> out) {
+        auto stmt = statements.acquire(StatementId::SelectChunk);
+        bindBlob(stmt.get(), 1, manifest.streamId);
+        bindInt64(stmt.get(), 2, static_cast<std::int64_t>(index));
+        if (stepStatement(stmt.get()) != SQLITE_ROW) {
+            fail(Error::NotFound, "secret stream chunk is missing; the secret was replaced or removed");
+        }
+
+        const auto ciphertext = columnView(stmt.get(), 1);
+        if (openedSize(ciphertext) != out.size()) {
+            fail(Error::DataCorrupted, "secret stream chunk has an unexpected size");
+        }
+        aeadDecryptInto(ciphertext,
+                        columnView(stmt.get(), 0),
+                        keys.dek(),
+                        chunkAad(manifest.streamId, index, index + 1 == manifest.chunkCount),
+                        out);
+    }
+
+    [[nodiscard]] static bytes loadChunk(const KeySchedule& keys,
+                                         StatementCache& statements,
+                                         const StreamManifest& manifest,
+                                         std::uint64_t index) {
+        bytes chunk(manifest.chunkLength(index));
+        loadChunkInto(keys, statements, manifest, index, chunk);
+        return chunk;
+    }
+
+    void insertChunk(const StreamManifest& manifest,
+                     std::uint64_t index,
+                     std::span<const unsigned char> plaintext,
+                     const KeySchedule& keys) {
+        bytes nonce;
+        const auto ciphertext = aeadEncrypt(plaintext,
+                                            keys.dek(),
+                                            chunkAad(manifest.streamId, index, index + 1 == manifest.chunkCount),
+                                            nonce);
+        auto stmt = statements_.acquire(StatementId::InsertChunk);
+        bindBlob(stmt.get(), 1, manifest.streamId);
+        bindInt64(stmt.get(), 2, static_cast<std::int64_t>(index));
+        bindBlob(stmt.get(), 3, nonce);
+        bindBlob(stmt.get(), 4, ciphertext);
+        stepDone(db_.get(), stmt.get());
+    }
+
+    [[nodiscard]] static bytes decodeListCursor(std::string_view cursor) {
+        if (cursor.empty()) {
+            return {};
+        }
+        if (cursor.size() != crypto_generichash_BYTES * 2) {
+            fail(Error::InvalidArgument, "list cursor is invalid");
+        }
+        try {
+            return hexToBytes(cursor);
+        } catch (const std::exception&) {
+            fail(Error::InvalidArgument, "list cursor is invalid");
+        }
+    }
+
+    [[nodiscard]] static std::int64_t sqlLimit(std::size_t limit) {
+        if (limit == 0 || limit > static_cast<std::size_t>(std::numeric_limits<std::int64_t>::max() - 1)) {
+            return -1;
+        }
+        return static_cast<std::int64_t>(limit);
+    }
+
+    // Stream secrets in name-hash order, starting after the `after` hash
+    // (empty for the beginning) and stopping after `limit` rows (-1 for all).
+    // Rows are read in chunks of kScanChunkRows, decrypted (across the scan
+    // workers when more than one is configured) and handed to
+    // fn(nameHash, Info&&) in row order, so memory use is bounded by the chunk
+    // size rather than the namespace size. fn returns false to stop early.
+    template <typename Fn>
+    void scanSecrets(const KeySchedule& keys,
+                     const bytes& after,
+                     std::int64_t limit,
+                     bool includeDescriptions,
+                     Fn&& fn) const {
+        const ReadAccess connection(*this);
+        auto stmt = connection.statements().acquire(StatementId::ListSecrets);
+        if (after.empty()) {
+            // A NULL pointer would bind SQL NULL, which compares false with everything.
+            if (sqlite3_bind_zeroblob(stmt.get(), 1, 0) != SQLITE_OK) {
+                throw std::runtime_error("failed to bind blob");
+            }
+        } else {
+            bindBlob(stmt.get(), 1, after);
+        }
+        bindInt64(stmt.get(), 2, limit);
+
+        const auto pool = scanPool();
+        std::vector<EncryptedInfo> rows;
+        std::vector<Info> decrypted;
+        int rc = SQLITE_ROW;
+        while (rc == SQLITE_ROW) {
+            rows.clear();
+            while (rows.size() < kScanChunkRows && (rc = stepStatement(stmt.get())) == SQLITE_ROW) {
+                auto& row = rows.emplace_back();
+                row.nameHash = columnBlob(stmt.get(), 0);
+                row.nameNonce = columnBlob(stmt.get(), 1);
+                row.nameCiphertext = columnBlob(stmt.get(), 2);
+                if (includeDescriptions) {
+                    row.descriptionNonce = columnOptionalBlob(stmt.get(), 3);
+                    row.descriptionCiphertext = columnOptionalBlob(stmt.get(), 4);
+                }
+            }
+
+            decrypted.clear();
+            decrypted.resize(rows.size());
+            const auto decryptRow = [&keys, &rows, &decrypted](std::size_t i) {
+                decrypted[i] = decryptInfo(keys, rows[i]);
+            };
+            if (pool != nullptr && rows.size() > 1) {
+                pool->parallelFor(rows.size(), decryptRow);
+            } else {
+                for (std::size_t i = 0; i < rows.size(); ++i) {
+                    decryptRow(i);
+                }
+            }
+
+            for (std::size_t i = 0; i < rows.size(); ++i) {
+                if (!fn(rows[i].nameHash, std::move(decrypted[i]))) {
+                    return;
+                }
+            }
+        }
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error(sqlite3_errmsg(connection.db()));
+        }
+    }
+
+    [[nodiscard]] static Info decryptInfo(const KeySchedule& keys, const EncryptedInfo& row) {
+        const auto decryptedName = aeadDecrypt(row.nameCiphertext,
+                                               row.nameNonce,
+                                               keys.dek(),
+                                               SecretAad(kAadSecretName, row.nameHash).view());
+        Info info{
+            .name = std::string(reinterpret_cast<const char*>(decryptedName.data()), decryptedName.size()),
+            .description = {},
+        };
+        if (row.descriptionNonce.has_value() && row.descriptionCiphertext.has_value()) {
+            const auto decryptedDescription = aeadDecrypt(*row.descriptionCiphertext,
+                                                          *row.descriptionNonce,
+                                                          keys.dek(),
+                                                          SecretAad(kAadSecretDescription, row.nameHash).view());
+            info.description.assign(reinterpret_cast<const char*>(decryptedDescription.data()),
+                                    decryptedDescription.size());
+        }
+        return info;
+    }
+
+    // Worker pool for scans, or nullptr when scans run on the calling thread.
+    // The calling thread takes part in the work, so N scan workers means
+    // N - 1 pool threads.
+    [[nodiscard]] std::shared_ptr<WorkerPool> scanPool() const {
+        const std::scoped_lock lock(scanPoolMutex_);
+        const auto workers = scanWorkers_ == 0
+            ? std::max<std::size_t>(1, std::thread::hardware_concurrency())
+            : scanWorkers_;
+        if (workers <= 1) {
+            return nullptr;
+        }
+        if (!scanPool_ || scanPool_->size() != workers - 1) {
+            scanPool_ = std::make_shared<WorkerPool>(workers - 1);
+        }
+        return scanPool_;
+    }
+
+    void updateMetadataTimestamp() {
+        auto stmt = statements_.acquire(StatementId::UpdateMetadataTimestamp);
+        bindInt64(stmt.get(), 1, nowSeconds());
+        stepDone(db_.get(), stmt.get());
+    }
+
+    // One atomic unit of writes on the writer connection. The caller holds
+    // writeMutex_. With Full or Normal durability it is a transaction of its
+    // own. With Deferred durability it is a savepoint inside the pending group
+    // transaction, so a failed unit is undone without touching the others.
+    class WriteScope {
+    public:
+        explicit WriteScope(Impl& impl) : impl_(impl) {
+            impl_.writer();
+            if (impl_.durability_ != Durability::Deferred) {
+                transaction_.emplace(impl_.db_.get());
+                impl_.requireNamespace(impl_.statements_);
+                return;
+            }
+            impl_.reportGroupError();
+            impl_.beginGroup();
+            impl_.requireNamespace(impl_.statements_);
+            execute(impl_.db_.get(), "SAVEPOINT write_scope");
         }
 
-        auto db = openDatabase(dbPath, false);
-        validateSchema(db.get(), namespaceName);
+        WriteScope(const WriteScope&) = delete;
+        WriteScope& operator=(const WriteScope&) = delete;
 
-        auto impl = std::make_unique<Impl>(namespaceName, std::move(db), dbPath, makeVaultBackend());
-        auto result = std::unique_ptr<SafeKeeping>(new SafeKeeping(std::move(impl)));
+        ~WriteScope() {
+            if (committed_ || transaction_.has_value()) {
+                return;
+            }
+            sqlite3_exec(impl_.db_.get(), "ROLLBACK TO write_scope", nullptr, nullptr, nullptr);
+            sqlite3_exec(impl_.db_.get(), "RELEASE write_scope", nullptr, nullptr, nullptr);
+        }
 
-        if (options.trySystemVaultFirst) {
-            result->unlockWithSystemVault();
+        void commit() {
+            if (transaction_.has_value()) {
+                transaction_->commit();
+            } else {
+                execute(impl_.db_.get(), "RELEASE write_scope");
+            }
+            committed_ = true;
         }
-        if (!result->isUnlocked() && options.passphrase.has_value()) {
-            result->unlockWithPassphrase(*options.passphrase);
+
+    private:
+        Impl& impl_;
+        std::optional<Transaction> transaction_;
+        bool committed_ = false;
+    };
+
+    // Connection for one read. Normally a pooled read connection. While a
+    // Deferred group is pending it is the writer connection, so callers see
+    // their own writes before they are committed.
+    class ReadAccess {
+    public:
+        explicit ReadAccess(const Impl& impl) {
+            impl.ensureReady();
+            if (impl.groupOpen_.load(std::memory_order_acquire)) {
+                writeLock_ = std::unique_lock(impl.writeMutex_);
+                if (impl.groupOpen_) {
+                    statements_ = &impl.statements_;
+                    impl.requireNamespace(*statements_);
+                    return;
+                }
+                writeLock_.unlock();
+            }
+            lease_.emplace(impl.readers_->acquire(impl.namespaceId_));
+            statements_ = &lease_->statements();
+            // After the lease, so a close from here on also drops it.
+            impl.touch();
+            impl.requireNamespace(*statements_);
         }
-        if (!result->isUnlocked() && options.recoveryKey.has_value()) {
-            result->unlockWithRecoveryKey(*options.recoveryKey);
+
+        [[nodiscard]] StatementCache& statements() const noexcept {
+            return *statements_;
         }
-        return result;
-    }
 
-    static bool exists(std::string_view namespaceName) {
-        return std::filesystem::exists(databasePath(namespaceName));
-    }
+        [[nodiscard]] sqlite3* db() const noexcept {
+            return statements_->db();
+        }
 
-    static bool removeNamespace(std::string namespaceName) {
-        validateNamespaceOrSecretName(namespaceName, "namespace");
-        const auto dbPath = databasePath(namespaceName);
-        const bool dbExists = std::filesystem::exists(dbPath);
-        const auto vaultBackend = makeVaultBackend();
-        if (vaultBackend != nullptr && vaultBackend->available()) {
-            vaultBackend->remove(namespaceName, kVaultEntryName);
+    private:
+        std::unique_lock<std::recursive_mutex> writeLock_;
+        std::optional<ReadConnectionPool::Lease> lease_;
+        StatementCache* statements_ = nullptr;
+    };
+
+    // A namespace in the shared store can be removed while handles to it are
+    // open. Its id is not handed out again, so such a handle finds no rows;
+    // this makes its calls fail with NotFound instead. The name is matched
+    // too, for stores created before ids were AUTOINCREMENT.
+    void requireNamespace(StatementCache& statements) const {
+        if (!namespaceId_.has_value()) {
+            return;
+        }
+        auto stmt = statements.acquire(StatementId::NamespaceExists);
+        bindText(stmt.get(), 1, namespaceName_);
+        if (stepStatement(stmt.get()) != SQLITE_ROW) {
+            fail(Error::NotFound, "namespace was removed");
         }
-        std::error_code error;
-        std::filesystem::remove_all(dbPath.parent_path(), error);
-        return dbExists && !error;
     }
 
-    const std::string& namespaceName() const noexcept {
-        return namespaceName_;
+    // The writer connection and its statements, opened on first use and
+    // reopened if a manager closed them. Callers hold writeMutex_.
+    StatementCache& writer() const {
+        ensureReady();
+        connectWriter();
+        touch();
+        return statements_;
     }
 
-    bool isUnlocked() const noexcept {
-        return unlocked_;
+    void connectWriter() const {
+        if (readOnly_) {
+            fail(Error::ReadOnly, "namespace is open read-only");
+        }
+        if (!db_) {
+            db_ = openDatabase(dbPath_, false, durability_);
+            statements_.attach(db_.get());
+        }
     }
 
-    bool unlockWithSystemVault() {
-        if (unlocked_) {
-            return true;
+    // open() leaves the schema check and permission hardening to the first
+    // call that reads or writes. The check runs on a read connection, so a
+    // read-only caller never opens the writer unless the schema is migrated.
+    void ensureReady() const {
+        if (ready_.load(std::memory_order_acquire)) {
+            return;
         }
-        if (!hasSlot(db_.get(), kSlotTypeVault)) {
-            fail(Error::UnlockUnavailable, "system vault unlock slot is not configured");
+        const std::scoped_lock writeLock(writeMutex_);
+        if (ready_.load(std::memory_order_relaxed)) {
+            return;
         }
-        if (vaultBackend_ == nullptr || !vaultBackend_->available()) {
-            fail(Error::VaultError, "system vault backend is not available");
+        if (!readOnly_) {
+            lockDownDatabaseArtifacts(dbPath_);
         }
-
-        const auto material = vaultBackend_->load(namespaceName_, kVaultEntryName);
-        if (!material.has_value()) {
-            fail(Error::VaultError, "failed to load namespace material from the system vault");
+        const bool current = [this] {
+            const auto lease = readers_->acquire(namespaceId_);
+            return checkSchema(lease.db(), namespaceName_);
+        }();
+        if (!current && readOnly_) {
+            throw std::runtime_error("namespace schema must be migrated by a writable open first");
         }
-
-        try {
-            const auto slot = readSingleSlot(db_.get(), kSlotTypeVault);
-            const auto dek = unwrapDek(slot, deriveVaultKek(*material), "schema-1");
-            setUnlockedDek(dek);
-            return true;
-        } catch (const OperationError&) {
-            throw;
-        } catch (const std::exception&) {
-            fail(Error::UnlockFailed, "system vault material did not unlock the namespace");
+        if (!current) {
+            connectWriter();
+            migrateSchema(db_.get());
         }
+        ready_.store(true, std::memory_order_release);
     }
 
-    bool unlockWithPassphrase(std::string_view passphrase) {
-        if (unlocked_) {
-            return true;
-        }
-        if (!hasSlot(db_.get(), kSlotTypePassphrase)) {
-            fail(Error::UnlockUnavailable, "passphrase unlock slot is not configured");
-        }
+    // Built on first use, so an open that never reaches the vault skips it.
+    [[nodiscard]] VaultBackend* vaultBackend() const {
+        std::call_once(vaultOnce_, [this] {
+            vaultBackend_ = makeVaultBackend();
+        });
+        return vaultBackend_.get();
+    }
 
-        try {
-            const auto slot = readSingleSlot(db_.get(), kSlotTypePassphrase);
-            if (!slot.kdfSalt.has_value()) {
-                fail(Error::DataCorrupted, "passphrase slot is missing KDF salt");
+    // Marks a use for SafeKeepingManager, and tells it when connections it
+    // closed are in use again. Two relaxed loads when not managed.
+    void touch() const {
+        if (managed_.load(std::memory_order_relaxed)) {
+            lastUse_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+        if (closed_.load(std::memory_order_relaxed) && closed_.exchange(false)) {
+            std::function<void()> hook;
+            {
+                const std::scoped_lock lock(hookMutex_);
+                hook = reopenHook_;
+            }
+            if (hook) {
+                hook();
             }
-            const auto dek = unwrapDek(slot,
-                                       derivePassphraseKek(passphrase,
-                                                           *slot.kdfSalt,
-                                                           slot.kdfOpslimit,
-                                                           static_cast<std::size_t>(slot.kdfMemlimit)),
-                                       "schema-1");
-            setUnlockedDek(dek);
-            return true;
-        } catch (const OperationError&) {
-            throw;
-        } catch (const std::exception&) {
-            fail(Error::UnlockFailed, "passphrase did not unlock the namespace");
         }
     }
 
-    bool unlockWithRecoveryKey(std::string_view recoveryKey) {
-        if (unlocked_) {
-            return true;
+    // Group commit helpers. Callers hold writeMutex_.
+    void beginGroup() {
+        if (groupOpen_) {
+            return;
         }
-        if (!hasSlot(db_.get(), kSlotTypeRecovery)) {
-            fail(Error::UnlockUnavailable, "recovery key unlock slot is not configured");
+        {
+            const PhaseTimer timer(Phase::SqliteCommit);
+            execute(db_.get(), "BEGIN IMMEDIATE TRANSACTION");
         }
+        groupDeadline_ = std::chrono::steady_clock::now() + groupCommitWindow_;
+        groupOpen_ = true;
+        groupCommitWake_.notify_all();
+    }
 
+    void commitGroup() {
+        if (!groupOpen_) {
+            return;
+        }
         try {
-            const auto slot = readSingleSlot(db_.get(), kSlotTypeRecovery);
-            if (!slot.kdfSalt.has_value()) {
-                fail(Error::DataCorrupted, "recovery slot is missing KDF salt");
+            const PhaseTimer timer(Phase::SqliteCommit);
+            execute(db_.get(), "COMMIT");
+        } catch (const std::exception&) {
+            // A busy database keeps the transaction open for a retry. Other
+            // failures roll it back, and the group is gone.
+            if (sqlite3_get_autocommit(db_.get()) != 0) {
+                groupOpen_ = false;
             }
-            const auto dek = unwrapDek(slot,
-                                       derivePassphraseKek(normalizeRecoveryKey(recoveryKey),
-                                                           *slot.kdfSalt,
-                                                           slot.kdfOpslimit,
-                                                           static_cast<std::size_t>(slot.kdfMemlimit)),
-                                       "schema-1");
-            setUnlockedDek(dek);
-            return true;
-        } catch (const OperationError&) {
             throw;
-        } catch (const std::exception&) {
-            fail(Error::UnlockFailed, "recovery key did not unlock the namespace");
         }
+        groupOpen_ = false;
+        lockDownDatabaseArtifacts(dbPath_);
     }
 
-    bool lock() {
-        if (!dek_.empty()) {
-            sodium_memzero(dek_.data(), dek_.size());
-            dek_.clear();
+    void runGroupCommits() {
+        std::unique_lock writeLock(writeMutex_);
+        while (!stopGroupCommits_) {
+            if (!groupOpen_) {
+                groupCommitWake_.wait(writeLock);
+                continue;
+            }
+            const bool woken = groupCommitWake_.wait_until(writeLock, groupDeadline_, [this] {
+                return stopGroupCommits_ || !groupOpen_;
+            });
+            if (woken) {
+                continue;
+            }
+            try {
+                commitGroup();
+            } catch (const std::exception& error) {
+                if (!groupOpen_) {
+                    // Rolled back with nobody waiting on it; keep the error
+                    // for whoever flushes, locks or writes next.
+                    groupError_ = std::string("deferred writes were rolled back: ") + error.what();
+                    continue;
+                }
+                groupDeadline_ = std::chrono::steady_clock::now() + groupCommitWindow_;
+            }
         }
-        unlocked_ = false;
-        return true;
     }
 
-    bool storeSecret(std::string_view name,
-                     byte_view secret,
-                     std::optional<std::string_view> description = std::nullopt) {
-        requireUnlocked();
-        validateNamespaceOrSecretName(name, "secret name");
-        validateSecretValue(secret);
-        if (description.has_value()) {
-            validateDescription(*description);
-        }
-
-        const bytes nameHash = computeNameHash(dek_, name);
-        SecretRecord record;
-        record.nameHash = nameHash;
-        record.nameCiphertext = aeadEncrypt(toBytes(name),
-                                            dek_,
-                                            "secret-name-v1:" + bytesToHex(nameHash),
-                                            record.nameNonce);
-        record.valueCiphertext = aeadEncrypt(toBytes(secret),
-                                             dek_,
-                                             "secret-value-v1:" + bytesToHex(nameHash),
-                                             record.valueNonce);
-        if (description.has_value()) {
-            bytes nonce;
-            record.descriptionCiphertext = aeadEncrypt(
-                toBytes(*description),
-                dek_,
-                "secret-description-v1:" + bytesToHex(nameHash),
-                nonce);
-            record.descriptionNonce = std::move(nonce);
+    // Throws, once, the failure of a background commit that lost a group.
+    void reportGroupError() {
+        if (!groupError_) {
+            return;
         }
-
-        Transaction txn(db_.get());
-        auto stmt = prepare(
-            db_.get(),
-            "INSERT INTO secrets (name_hash, name_nonce, name_ciphertext, value_nonce, value_ciphertext, "
-            "description_nonce, description_ciphertext, created_at, updated_at) "
-            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?) "
-            "ON CONFLICT(name_hash) DO UPDATE SET "
-            "name_nonce = excluded.name_nonce, "
-            "name_ciphertext = excluded.name_ciphertext, "
-            "value_nonce = excluded.value_nonce, "
-            "value_ciphertext = excluded.value_ciphertext, "
-            "description_nonce = excluded.description_nonce, "
-            "description_ciphertext = excluded.description_ciphertext, "
-            "updated_at = excluded.updated_at");
-        const auto now = nowSeconds();
-        bindBlob(stmt.get(), 1, record.nameHash);
-        bindBlob(stmt.get(), 2, record.nameNonce);
-        bindBlob(stmt.get(), 3, record.nameCiphertext);
-        bindBlob(stmt.get(), 4, record.valueNonce);
-        bindBlob(stmt.get(), 5, record.valueCiphertext);
-        bindOptionalBlob(stmt.get(), 6, record.descriptionNonce);
-        bindOptionalBlob(stmt.get(), 7, record.descriptionCiphertext);
-        bindInt64(stmt.get(), 8, now);
-        bindInt64(stmt.get(), 9, now);
-        stepDone(db_.get(), stmt.get());
-        updateMetadataTimestamp();
-        txn.commit();
-        lockDownDatabaseArtifacts(dbPath_);
-        return true;
+        const std::string message = std::move(*groupError_);
+        groupError_.reset();
+        throw std::runtime_error(message);
     }
 
-    std::optional<std::vector<std::byte>> retrieveSecretBytes(std::string_view name) const {
-        requireUnlocked();
-        validateNamespaceOrSecretName(name, "secret name");
-        const bytes nameHash = computeNameHash(dek_, name);
-        auto stmt = prepare(
-            db_.get(),
-            "SELECT name_nonce, name_ciphertext, value_nonce, value_ciphertext "
-            "FROM secrets WHERE name_hash = ?");
-        bindBlob(stmt.get(), 1, nameHash);
-        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
-            fail(Error::NotFound, "secret was not found");
-        }
-
-        const bytes nameNonce = columnBlob(stmt.get(), 0);
-        const bytes nameCiphertext = columnBlob(stmt.get(), 1);
-        const bytes valueNonce = columnBlob(stmt.get(), 2);
-        const bytes valueCiphertext = columnBlob(stmt.get(), 3);
-
-        const auto decryptedNameBytes = aeadDecrypt(nameCiphertext,
-                                                    nameNonce,
-                                                    dek_,
-                                                    "secret-name-v1:" + bytesToHex(nameHash));
-        const std::string decryptedName(reinterpret_cast<const char*>(decryptedNameBytes.data()),
-                                        decryptedNameBytes.size());
+    // Snapshot of the key schedule for one operation. Holding the snapshot
+    // keeps the keys alive if another thread calls lock() meanwhile; the
+    // guarded memory is wiped when the last snapshot is released.
+    [[nodiscard]] std::shared_ptr<const KeySchedule> currentKeys() const {
+        const std::shared_lock keysLock(keyMutex_);
+        return keys_;
+    }
 
-        if (decryptedName != name) {
-            fail(Error::DataCorrupted, "secret name payload is corrupted");
+    [[nodiscard]] std::shared_ptr<const KeySchedule> unlockedKeys() const {
+        auto keys = currentKeys();
+        if (!keys) {
+            fail(Error::Locked, "namespace is locked");
         }
+        return keys;
+    }
 
-        const auto plaintext = aeadDecrypt(valueCiphertext,
-                                           valueNonce,
-                                           dek_,
-                                           "secret-value-v1:" + bytesToHex(nameHash));
-        return toByteVector(plaintext);
+    [[nodiscard]] static Unexpected<ErrorInfo> lockedFailure() {
+        return failure(Error::Locked, "namespace is locked");
     }
 
-    bool removeSecret(std::string_view name) {
-        requireUnlocked();
-        validateNamespaceOrSecretName(name, "secret name");
-        Transaction txn(db_.get());
-        auto stmt = prepare(db_.get(), "DELETE FROM secrets WHERE name_hash = ?");
-        bindBlob(stmt.get(), 1, computeNameHash(dek_, name));
-        stepDone(db_.get(), stmt.get());
-        const bool removed = sqlite3_changes(db_.get()) > 0;
-        if (!removed) {
-            fail(Error::NotFound, "secret was not found");
+    // Mutating calls check this before anything else.
+    [[nodiscard]] std::optional<ErrorInfo> checkWritable() const {
+        if (readOnly_) {
+            return ErrorInfo{.error = Error::ReadOnly, .message = "namespace is open read-only"};
         }
-        updateMetadataTimestamp();
-        txn.commit();
-        return true;
+        return std::nullopt;
     }
 
-    info_list_t listSecrets() const {
-        requireUnlocked();
-        auto stmt = prepare(
-            db_.get(),
-            "SELECT name_hash, name_nonce, name_ciphertext, description_nonce, description_ciphertext FROM secrets");
-        info_list_t list;
-        while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
-            const bytes nameHash = columnBlob(stmt.get(), 0);
-            const bytes nameNonce = columnBlob(stmt.get(), 1);
-            const bytes nameCiphertext = columnBlob(stmt.get(), 2);
-            const auto descriptionNonce = columnOptionalBlob(stmt.get(), 3);
-            const auto descriptionCiphertext = columnOptionalBlob(stmt.get(), 4);
-
-            const auto decryptedName = aeadDecrypt(nameCiphertext,
-                                                   nameNonce,
-                                                   dek_,
-                                                   "secret-name-v1:" + bytesToHex(nameHash));
-            std::string description;
-            if (descriptionNonce.has_value() && descriptionCiphertext.has_value()) {
-                const auto decryptedDescription = aeadDecrypt(*descriptionCiphertext,
-                                                              *descriptionNonce,
-                                                              dek_,
-                                                              "secret-description-v1:" + bytesToHex(nameHash));
-                description.assign(reinterpret_cast<const char*>(decryptedDescription.data()),
-                                   decryptedDescription.size());
-            }
-            list.push_back({
-                .name = std::string(reinterpret_cast<const char*>(decryptedName.data()), decryptedName.size()),
-                .description = std::move(description),
-            });
+    void requireWritable() const {
+        if (auto error = checkWritable()) {
+            fail(error->error, std::move(error->message));
         }
-
-        std::sort(list.begin(), list.end(), [](const Info& lhs, const Info& rhs) {
-            return lhs.name < rhs.name;
-        });
-        return list;
     }
 
-    bool hasSystemVaultSlot() const {
-        return hasSlot(db_.get(), kSlotTypeVault);
+    [[nodiscard]] SlotRecord readSlot(std::string_view slotType) const {
+        const ReadAccess connection(*this);
+        return readSingleSlot(connection.statements(), slotType);
     }
 
-    bool hasPassphraseSlot() const {
-        return hasSlot(db_.get(), kSlotTypePassphrase);
-    }
+    struct SharedEntry {
+        std::mutex mutex;
+        std::weak_ptr<SafeKeeping> handle;
+    };
 
-    bool hasRecoverySlot() const {
-        return hasSlot(db_.get(), kSlotTypeRecovery);
+    [[nodiscard]] static std::mutex& sharedMutex() {
+        static std::mutex mutex;
+        return mutex;
     }
 
-    std::vector<UnlockMethod> availableUnlockMethods() const {
-        return listUnlockMethods(db_.get());
+    [[nodiscard]] static std::map<std::string, std::shared_ptr<SharedEntry>>& sharedEntries() {
+        static std::map<std::string, std::shared_ptr<SharedEntry>> entries;
+        return entries;
     }
 
-    bool addSystemVaultSlot() {
-        requireUnlocked();
-        if (hasSystemVaultSlot()) {
-            fail(Error::AlreadyExists, "system vault slot already exists");
-        }
-        if (vaultBackend_ == nullptr || !vaultBackend_->available()) {
-            fail(Error::VaultError, "system vault backend is not available");
-        }
-
-        const std::string material = bytesToHex(randomBytes(32));
-        if (!vaultBackend_->store(namespaceName_, kVaultEntryName, material)) {
-            const std::string detail = vaultBackend_->lastErrorMessage();
-            fail(Error::VaultError,
-                 detail.empty() ? "failed to store namespace material in the system vault"
-                                : "failed to store namespace material in the system vault: " + detail);
-        }
-
-        Transaction txn(db_.get());
-        insertSlot(db_.get(),
-                   buildWrappedSlot("vault",
-                                    "vault",
-                                    dek_,
-                                    deriveVaultKek(material),
-                                    std::nullopt,
-                                    std::nullopt,
-                                    0,
-                                    0));
-        updateMetadataTimestamp();
-        txn.commit();
-        return true;
+    // Page cache counters of the writer and the idle read connections.
+    void addSqliteStatus(Stats& stats) const {
+        addWriterStatus(stats);
+        addReaderStatus(stats);
     }
 
-    bool addPassphrase(std::string_view passphrase) {
-        requireUnlocked();
-        if (hasPassphraseSlot()) {
-            fail(Error::AlreadyExists, "passphrase slot already exists");
+    void addWriterStatus(Stats& stats) const {
+        const std::scoped_lock writeLock(writeMutex_);
+        if (db_) {
+            addConnectionStatus(db_.get(), stats);
         }
+    }
 
-        const bytes salt = randomBytes(crypto_pwhash_SALTBYTES);
-        const auto kek = derivePassphraseKek(passphrase,
-                                             salt,
-                                             crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                                             crypto_pwhash_MEMLIMIT_INTERACTIVE);
-        Transaction txn(db_.get());
-        insertSlot(db_.get(),
-                   buildWrappedSlot("passphrase",
-                                    "passphrase",
-                                    dek_,
-                                    kek,
-                                    std::string("argon2id"),
-                                    salt,
-                                    crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                                    crypto_pwhash_MEMLIMIT_INTERACTIVE));
-        updateMetadataTimestamp();
-        txn.commit();
-        return true;
+    void addReaderStatus(Stats& stats) const {
+        readers_->forEachIdle([&stats](sqlite3* db) {
+            addConnectionStatus(db, stats);
+        });
     }
 
-    bool changePassphrase(std::string_view newPassphrase) {
-        requireUnlocked();
-        if (!hasPassphraseSlot()) {
-            fail(Error::NotFound, "passphrase slot does not exist");
+    // Drop the idle read connections. The shared store's pool serves every
+    // namespace in it and keeps no state of any one of them, so it is left
+    // alone.
+    void closeReaders() const {
+        if (!namespaceId_.has_value()) {
+            readers_->clear();
         }
-
-        const bytes salt = randomBytes(crypto_pwhash_SALTBYTES);
-        const auto kek = derivePassphraseKek(newPassphrase,
-                                             salt,
-                                             crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                                             crypto_pwhash_MEMLIMIT_INTERACTIVE);
-        Transaction txn(db_.get());
-        removeActiveSlot(db_.get(), kSlotTypePassphrase);
-        insertSlot(db_.get(),
-                   buildWrappedSlot("passphrase",
-                                    "passphrase",
-                                    dek_,
-                                    kek,
-                                    std::string("argon2id"),
-                                    salt,
-                                    crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                                    crypto_pwhash_MEMLIMIT_INTERACTIVE));
-        updateMetadataTimestamp();
-        txn.commit();
-        return true;
     }
 
-    bool removePassphrase() {
-        requireUnlocked();
-        if (!hasPassphraseSlot()) {
-            fail(Error::NotFound, "passphrase slot does not exist");
+    // Namespaces in the shared store share its read pool, so idle read
+    // connections do not grow with the number of open namespaces.
+    [[nodiscard]] static std::shared_ptr<ReadConnectionPool> readPool(const std::filesystem::path& dbPath,
+                                                                      bool shared,
+                                                                      std::int64_t mmapSize) {
+        if (!shared) {
+            return std::make_shared<ReadConnectionPool>(dbPath, mmapSize);
         }
-        if (activeSlotCount(db_.get()) <= 1) {
-            fail(Error::InvalidArgument, "cannot remove the last unlock method");
+        static std::mutex mutex;
+        static std::map<std::pair<std::filesystem::path, std::int64_t>, std::weak_ptr<ReadConnectionPool>> pools;
+        const std::scoped_lock lock(mutex);
+        std::erase_if(pools, [](const auto& item) {
+            return item.second.expired();
+        });
+        auto& slot = pools[{dbPath, mmapSize}];
+        auto pool = slot.lock();
+        if (!pool) {
+            pool = std::make_shared<ReadConnectionPool>(dbPath, mmapSize);
+            slot = pool;
         }
-
-        Transaction txn(db_.get());
-        removeActiveSlot(db_.get(), kSlotTypePassphrase);
-        updateMetadataTimestamp();
-        txn.commit();
-        return true;
+        return pool;
     }
 
-    std::optional<std::string> rotateRecoveryKey() {
-        requireUnlocked();
-        if (!hasRecoverySlot() && activeSlotCount(db_.get()) == 0) {
-            fail(Error::InvalidArgument, "cannot rotate recovery key without an active unlock method");
-        }
+    struct ThreadErrors {
+        std::map<std::uint64_t, LatestError> errors;
+        // destroyedInstances() when the map was last pruned.
+        std::uint64_t destroyed = 0;
+    };
 
-        auto [formattedKey, rawRecovery] = generateRecoverySecret();
-        const bytes salt = randomBytes(crypto_pwhash_SALTBYTES);
-        const auto kek = derivePassphraseKek(normalizeRecoveryKey(formattedKey),
-                                             salt,
-                                             crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                                             crypto_pwhash_MEMLIMIT_INTERACTIVE);
-        Transaction txn(db_.get());
-        removeActiveSlot(db_.get(), kSlotTypeRecovery);
-        insertSlot(db_.get(),
-                   buildWrappedSlot("recovery",
-                                    "recovery",
-                                    dek_,
-                                    kek,
-                                    std::string("argon2id"),
-                                    salt,
-                                    crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                                    crypto_pwhash_MEMLIMIT_INTERACTIVE));
-        updateMetadataTimestamp();
-        txn.commit();
-        sodium_memzero(rawRecovery.data(), rawRecovery.size());
-        return formattedKey;
+    [[nodiscard]] static ThreadErrors& threadErrors() {
+        thread_local ThreadErrors errors;
+        return errors;
     }
 
-    bool removeRecoveryKey() {
-        requireUnlocked();
-        if (!hasRecoverySlot()) {
-            fail(Error::NotFound, "recovery slot does not exist");
+    [[nodiscard]] static std::atomic<std::uint64_t>& destroyedInstances() {
+        static std::atomic<std::uint64_t> destroyed{0};
+        return destroyed;
+    }
+
+    // This thread's errors, without those of instances destroyed since the
+    // last prune. Only takes instancesMutex() when there is something to drop.
+    static ThreadErrors& pruneThreadErrors() {
+        auto& local = threadErrors();
+        const auto destroyed = destroyedInstances().load(std::memory_order_acquire);
+        if (destroyed == local.destroyed) {
+            return local;
         }
-        if (activeSlotCount(db_.get()) <= 1) {
-            fail(Error::InvalidArgument, "cannot remove the last unlock method");
+        local.destroyed = destroyed;
+        if (local.errors.empty()) {
+            return local;
         }
-
-        Transaction txn(db_.get());
-        removeActiveSlot(db_.get(), kSlotTypeRecovery);
-        updateMetadataTimestamp();
-        txn.commit();
-        return true;
+        std::set<std::uint64_t> live;
+        {
+            const std::scoped_lock lock(instancesMutex());
+            for (const auto* impl : instances()) {
+                live.insert(impl->serial_);
+            }
+        }
+        std::erase_if(local.errors, [&live](const auto& item) {
+            return !live.contains(item.first);
+        });
+        return local;
     }
 
-    void clearLastError() const {
-        lastError_ = {};
+    [[nodiscard]] static std::uint64_t nextSerial() noexcept {
+        static std::atomic<std::uint64_t> serial{0};
+        return serial.fetch_add(1, std::memory_order_relaxed) + 1;
     }
 
-    void setLastError(Error error, std::string message) const {
-        lastError_ = {.error = error, .message = std::move(message)};
+    [[nodiscard]] static std::mutex& prefetchMutex() {
+        static std::mutex mutex;
+        return mutex;
     }
 
-    [[nodiscard]] LatestError latestError() const {
-        return lastError_;
+    // Vault material from prefetchVaultMaterial(), by namespace.
+    [[nodiscard]] static std::map<std::string, SecureBuffer, std::less<>>& prefetchedMaterial() {
+        static std::map<std::string, SecureBuffer, std::less<>> material;
+        return material;
     }
 
-private:
+    // Prefetched material serves one unlock and is then wiped.
+    [[nodiscard]] static std::optional<SecureBuffer> takePrefetchedMaterial(std::string_view namespaceName) {
+        const std::scoped_lock lock(prefetchMutex());
+        const auto it = prefetchedMaterial().find(namespaceName);
+        if (it == prefetchedMaterial().end()) {
+            return std::nullopt;
+        }
+        auto material = std::move(it->second);
+        prefetchedMaterial().erase(it);
+        return material;
+    }
 
-    void updateMetadataTimestamp() {
-        auto stmt = prepare(db_.get(), "UPDATE metadata SET updated_at = ?");
-        bindInt64(stmt.get(), 1, nowSeconds());
-        stepDone(db_.get(), stmt.get());
+    [[nodiscard]] static std::mutex& instancesMutex() {
+        static std::mutex mutex;
+        return mutex;
     }
 
-    void requireUnlocked() const {
-        if (!unlocked_) {
-            fail(Error::Locked, "namespace is locked");
-        }
+    [[nodiscard]] static std::vector<Impl*>& instances() {
+        static std::vector<Impl*> instances;
+        return instances;
     }
 
-    void setUnlockedDek(const bytes& dek) {
-        if (dek.size() != crypto_aead_xchacha20poly1305_ietf_KEYBYTES) {
-            throw std::runtime_error("unexpected DEK size");
-        }
-        dek_ = dek;
+    // Install the DEK and derive the per-purpose key schedule from it. The
+    // caller's copy is wiped once it has been moved into guarded memory.
+    void setUnlockedDek(bytes& dek) {
+        auto keys = std::make_shared<const KeySchedule>(dek);
+        sodium_memzero(dek.data(), dek.size());
+        const std::unique_lock keysLock(keyMutex_);
+        keys_ = std::move(keys);
         unlocked_ = true;
     }
 
     std::string namespaceName_;
-    sqlite_ptr db_;
+    // Opened on first use; see writer().
+    mutable sqlite_ptr db_;
+    // Declared after db_ so cached statements are finalized before the connection closes.
+    mutable StatementCache statements_;
+    // Serializes use of db_ and statements_. Readers only take it while a
+    // Deferred group is pending. Recursive so a read inside a write, or a
+    // write from a listing visitor, works in that state.
+    mutable std::recursive_mutex writeMutex_;
     std::filesystem::path dbPath_;
-    std::unique_ptr<VaultBackend> vaultBackend_;
-    bytes dek_;
-    bool unlocked_ = false;
-    mutable LatestError lastError_;
+    // Set for namespaces in the shared store.
+    std::optional<std::int64_t> namespaceId_;
+    std::shared_ptr<ReadConnectionPool> readers_;
+    mutable std::once_flag vaultOnce_;
+    mutable std::unique_ptr<VaultBackend> vaultBackend_;
+    // Schema checked and files hardened; see ensureReady().
+    mutable std::atomic<bool> ready_;
+    mutable std::shared_mutex keyMutex_;
+    std::shared_ptr<const KeySchedule> keys_;
+    std::atomic<bool> unlocked_ = false;
+    mutable std::mutex scanPoolMutex_;
+    std::size_t scanWorkers_ = 1;
+    mutable std::shared_ptr<WorkerPool> scanPool_;
+    mutable SecretCache cache_;
+    mutable Metrics metrics_;
+    const Durability durability_;
+    const std::chrono::milliseconds groupCommitWindow_;
+    const std::optional<KdfOptions> kdfOptions_;
+    // See OpenOptions::readOnly. db_ stays null for the instance's lifetime.
+    const bool readOnly_;
+    // Group commit state, guarded by writeMutex_. groupOpen_ is also read
+    // without the lock to route reads.
+    std::atomic<bool> groupOpen_ = false;
+    std::chrono::steady_clock::time_point groupDeadline_;
+    std::optional<std::string> groupError_;
+    bool stopGroupCommits_ = false;
+    std::condition_variable_any groupCommitWake_;
+    std::thread groupCommitThread_;
+    const std::uint64_t serial_ = nextSerial();
+    std::mutex asyncMutex_;
+    std::condition_variable asyncIdle_;
+    std::size_t asyncPending_ = 0;
+    // Last, so its writer thread stops before anything it reads goes away.
+    std::unique_ptr<AuditLog> audit_;
+    // SafeKeepingManager state.
+    std::atomic<bool> managed_{false};
+    mutable std::atomic<bool> closed_;
+    std::atomic<bool> evicted_{false};
+    mutable std::atomic<std::int64_t> lastUse_{0};
+    mutable std::mutex hookMutex_;
+    std::function<void()> reopenHook_;
 };
 
 SafeKeeping::SafeKeeping(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {}
@@ -1748,6 +5613,22 @@ SafeKeeping::~SafeKeeping() = default;
 
 namespace {
 
+// Executor for openAsync() and unlockAsync(). Kept small on purpose: each
+// passphrase or recovery key derivation uses about 64 MiB.
+WorkerPool& asyncExecutor() {
+    static WorkerPool pool(2);
+    return pool;
+}
+
+// Run a move-only task on the async executor.
+template <typename Fn>
+void runInBackground(Fn&& fn) {
+    auto task = std::make_shared<std::decay_t<Fn>>(std::forward<Fn>(fn));
+    asyncExecutor().submit([task] {
+        (*task)();
+    });
+}
+
 template <typename Fn>
 bool runBoolOperation(const auto& impl, Fn&& fn) {
     impl.clearLastError();
@@ -1786,12 +5667,87 @@ T runValueOperation(const auto& impl, T fallback, Fn&& fn) {
     return fallback;
 }
 
+
+// Adapt a result to the bool/optional API by recording any error in latestError().
+bool reportResult(const auto& impl, SafeKeeping::result_t<void>&& result) {
+    impl.clearLastError();
+    if (!result) {
+        auto error = std::move(result).error();
+        impl.setLastError(error.error, std::move(error.message));
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+std::optional<T> reportResult(const auto& impl, SafeKeeping::result_t<T>&& result) {
+    impl.clearLastError();
+    if (!result) {
+        auto error = std::move(result).error();
+        impl.setLastError(error.error, std::move(error.message));
+        return std::nullopt;
+    }
+    return std::move(result).value();
+}
+
 byte_view asByteView(std::string_view value) {
     return {reinterpret_cast<const std::byte*>(value.data()), value.size()};
 }
 
 } // namespace
 
+SafeKeeping::WriteBatch::WriteBatch() = default;
+SafeKeeping::WriteBatch::WriteBatch(WriteBatch&&) noexcept = default;
+SafeKeeping::WriteBatch& SafeKeeping::WriteBatch::operator=(WriteBatch&&) noexcept = default;
+SafeKeeping::WriteBatch::~WriteBatch() = default;
+
+SafeKeeping::WriteBatch& SafeKeeping::WriteBatch::store(std::string_view name, std::string_view secret) {
+    return store(name, asByteView(secret));
+}
+
+SafeKeeping::WriteBatch& SafeKeeping::WriteBatch::store(std::string_view name,
+                                                        std::span<const std::byte> secret) {
+    Operation operation;
+    operation.name = toString(name);
+    operation.value.assign(secret.begin(), secret.end());
+    operations_.push_back(std::move(operation));
+    return *this;
+}
+
+SafeKeeping::WriteBatch& SafeKeeping::WriteBatch::storeWithDescription(std::string_view name,
+                                                                       std::string_view secret,
+                                                                       std::string_view description) {
+    return storeWithDescription(name, asByteView(secret), description);
+}
+
+SafeKeeping::WriteBatch& SafeKeeping::WriteBatch::storeWithDescription(std::string_view name,
+                                                                       std::span<const std::byte> secret,
+                                                                       std::string_view description) {
+    store(name, secret);
+    operations_.back().description = toString(description);
+    return *this;
+}
+
+SafeKeeping::WriteBatch& SafeKeeping::WriteBatch::remove(std::string_view name) {
+    Operation operation;
+    operation.remove = true;
+    operation.name = toString(name);
+    operations_.push_back(std::move(operation));
+    return *this;
+}
+
+std::size_t SafeKeeping::WriteBatch::size() const noexcept {
+    return operations_.size();
+}
+
+bool SafeKeeping::WriteBatch::empty() const noexcept {
+    return operations_.empty();
+}
+
+void SafeKeeping::WriteBatch::clear() noexcept {
+    operations_.clear();
+}
+
 SafeKeeping::CreateResult SafeKeeping::createNew(std::string namespaceName) {
     return Impl::createNew(std::move(namespaceName), CreateOptions{});
 }
@@ -1817,15 +5773,98 @@ std::unique_ptr<SafeKeeping> SafeKeeping::openOrCreate(std::string namespaceName
 std::unique_ptr<SafeKeeping> SafeKeeping::openOrCreate(std::string namespaceName,
                                                        CreateOptions options) {
     if (exists(namespaceName)) {
-        return open(std::move(namespaceName));
+        UnlockOptions unlockOptions;
+        unlockOptions.open = options.open;
+        return open(std::move(namespaceName), std::move(unlockOptions));
     }
     return createNew(std::move(namespaceName), std::move(options)).instance;
 }
 
+std::future<SafeKeeping::result_t<SafeKeeping::ptr_t>> SafeKeeping::openAsync(std::string namespaceName,
+                                                                              UnlockOptions options,
+                                                                              std::stop_token stop) {
+    auto promise = std::make_shared<std::promise<result_t<ptr_t>>>();
+    auto future = promise->get_future();
+    openAsync(
+        std::move(namespaceName),
+        std::move(options),
+        [promise](result_t<ptr_t> result) {
+            promise->set_value(std::move(result));
+        },
+        std::move(stop));
+    return future;
+}
+
+void SafeKeeping::openAsync(std::string namespaceName,
+                            UnlockOptions options,
+                            std::function<void(result_t<ptr_t>)> done,
+                            std::stop_token stop) {
+    runInBackground([namespaceName = std::move(namespaceName),
+                            options = std::move(options),
+                            done = std::move(done),
+                            stop = std::move(stop)]() mutable {
+        auto result = runResultOperation<ptr_t>([&]() -> result_t<ptr_t> {
+            if (stop.stop_requested()) {
+                return Impl::cancelledFailure();
+            }
+            auto locked = options;
+            locked.trySystemVaultFirst = false;
+            locked.passphrase.reset();
+            locked.recoveryKey.reset();
+            auto instance = Impl::open(namespaceName, locked);
+            if (!instance) {
+                return Unexpected<ErrorInfo>({.error = Error::NotFound, .message = "namespace does not exist"});
+            }
+            auto unlocked = instance->impl_->unlock(options, stop);
+            if (!unlocked && unlocked.error().error == Error::Cancelled) {
+                return Unexpected(std::move(unlocked).error());
+            }
+            return instance;
+        });
+        done(std::move(result));
+    });
+}
+
+std::shared_ptr<SafeKeeping> SafeKeeping::openShared(std::string namespaceName) {
+    return Impl::openShared(std::move(namespaceName), UnlockOptions{});
+}
+
+std::shared_ptr<SafeKeeping> SafeKeeping::openShared(std::string namespaceName, UnlockOptions options) {
+    return Impl::openShared(std::move(namespaceName), options);
+}
+
+std::size_t SafeKeeping::lockAll() {
+    return Impl::lockAll();
+}
+
 void SafeKeeping::setLinuxVaultRootName(std::string name) {
     validateLinuxVaultRootName(name);
     std::scoped_lock lock(linuxVaultRootMutex());
     linuxVaultRootStorage() = std::move(name);
+    Impl::clearPrefetchedMaterial();
+}
+
+std::size_t SafeKeeping::prefetchVaultMaterial(std::span<const std::string> namespaceNames) {
+    return Impl::prefetchVaultMaterial(namespaceNames);
+}
+
+void SafeKeeping::setStoreLayout(StoreLayout layout) {
+    storeLayoutStorage().store(layout, std::memory_order_relaxed);
+}
+
+SafeKeeping::StoreLayout SafeKeeping::storeLayout() {
+    return jgaa::safekeeping::storeLayout();
+}
+
+void SafeKeeping::setSystemVaultTimeout(std::chrono::milliseconds timeout) {
+    if (timeout.count() <= 0 || timeout.count() > std::numeric_limits<unsigned int>::max()) {
+        throw std::invalid_argument("system vault timeout must be positive and fit in 32 bits of milliseconds");
+    }
+    systemVaultTimeoutStorage().store(timeout.count(), std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds SafeKeeping::systemVaultTimeout() {
+    return jgaa::safekeeping::systemVaultTimeout();
 }
 
 std::string SafeKeeping::linuxVaultRootName() {
@@ -1849,20 +5888,53 @@ bool SafeKeeping::isUnlocked() const noexcept {
 }
 
 bool SafeKeeping::unlockWithSystemVault() {
-    return runBoolOperation(*impl_, [this] {
-        return impl_->unlockWithSystemVault();
+    return measured(*impl_, Operation::UnlockSystemVault, [&] {
+        return runBoolOperation(*impl_, [this] {
+            return impl_->unlockWithSystemVault();
+        });
     });
 }
 
 bool SafeKeeping::unlockWithPassphrase(std::string_view passphrase) {
-    return runBoolOperation(*impl_, [this, passphrase] {
-        return impl_->unlockWithPassphrase(passphrase);
+    return measured(*impl_, Operation::UnlockPassphrase, [&] {
+        return runBoolOperation(*impl_, [this, passphrase] {
+            return impl_->unlockWithPassphrase(passphrase);
+        });
     });
 }
 
 bool SafeKeeping::unlockWithRecoveryKey(std::string_view recoveryKey) {
-    return runBoolOperation(*impl_, [this, recoveryKey] {
-        return impl_->unlockWithRecoveryKey(recoveryKey);
+    return measured(*impl_, Operation::UnlockRecoveryKey, [&] {
+        return runBoolOperation(*impl_, [this, recoveryKey] {
+            return impl_->unlockWithRecoveryKey(recoveryKey);
+        });
+    });
+}
+
+std::future<SafeKeeping::result_t<void>> SafeKeeping::unlockAsync(UnlockOptions options, std::stop_token stop) {
+    auto promise = std::make_shared<std::promise<result_t<void>>>();
+    auto future = promise->get_future();
+    unlockAsync(
+        std::move(options),
+        [promise](result_t<void> result) {
+            promise->set_value(std::move(result));
+        },
+        std::move(stop));
+    return future;
+}
+
+void SafeKeeping::unlockAsync(UnlockOptions options,
+                              std::function<void(result_t<void>)> done,
+                              std::stop_token stop) {
+    runInBackground([call = Impl::AsyncCall(*impl_),
+                            options = std::move(options),
+                            done = std::move(done),
+                            stop = std::move(stop)]() mutable {
+        auto result = runResultOperation<void>([&] {
+            return call.impl().unlock(options, stop);
+        });
+        call.release();
+        done(std::move(result));
     });
 }
 
@@ -1872,14 +5944,18 @@ bool SafeKeeping::lock() {
     });
 }
 
+bool SafeKeeping::flush() {
+    return runBoolOperation(*impl_, [this] {
+        return impl_->flush();
+    });
+}
+
 bool SafeKeeping::storeSecret(std::string_view name, std::string_view secret) {
     return storeSecret(name, asByteView(secret));
 }
 
 bool SafeKeeping::storeSecret(std::string_view name, std::span<const std::byte> secret) {
-    return runBoolOperation(*impl_, [this, name, secret] {
-        return impl_->storeSecret(name, secret);
-    });
+    return reportResult(*impl_, tryStoreSecret(name, secret));
 }
 
 bool SafeKeeping::storeSecretWithDescription(std::string_view name,
@@ -1891,37 +5967,390 @@ bool SafeKeeping::storeSecretWithDescription(std::string_view name,
 bool SafeKeeping::storeSecretWithDescription(std::string_view name,
                                              std::span<const std::byte> secret,
                                              std::string_view description) {
-    return runBoolOperation(*impl_, [this, name, secret, description] {
-        return impl_->storeSecret(name, secret, description);
+    return reportResult(*impl_, measured(*impl_, Operation::Store, name, [&] {
+        return runResultOperation<void>([this, name, secret, description] {
+            return impl_->storeSecret(name, secret, description);
+        });
+    }));
+}
+
+bool SafeKeeping::apply(const WriteBatch& batch) {
+    const bool applied = measured(*impl_, Operation::Store, std::nullopt, [&] {
+        return runBoolOperation(*impl_, [this, &batch] {
+            return impl_->applyBatch(batch.operations_);
+        });
+    });
+    const auto outcome = applied ? Error::None : impl_->latestError().error;
+    for (const auto& operation : batch.operations_) {
+        impl_->audit(operation.remove ? Operation::Remove : Operation::Store, operation.name, outcome);
+    }
+    return applied;
+}
+
+std::optional<SafeKeeping::lookup_list_t>
+SafeKeeping::retrieveSecrets(std::span<const std::string_view> names) const {
+    auto results = measured(*impl_, Operation::Retrieve, std::nullopt, [&] {
+        return runValueOperation(*impl_, std::optional<lookup_list_t>{}, [this, names] {
+            return impl_->retrieveSecrets(names);
+        });
     });
+    if (results.has_value()) {
+        for (const auto& result : *results) {
+            impl_->audit(Operation::Retrieve, result.name, result.error);
+        }
+    } else {
+        const auto outcome = impl_->latestError().error;
+        for (const auto name : names) {
+            impl_->audit(Operation::Retrieve, name, outcome);
+        }
+    }
+    return results;
 }
 
 std::optional<std::string> SafeKeeping::retrieveSecret(std::string_view name) const {
-    const auto value = retrieveSecretBytes(name);
-    if (!value.has_value()) {
-        return std::nullopt;
-    }
-    return std::string(reinterpret_cast<const char*>(value->data()), value->size());
+    return reportResult(*impl_, tryRetrieveSecret(name));
 }
 
 std::optional<std::vector<std::byte>> SafeKeeping::retrieveSecretBytes(std::string_view name) const {
-    return runValueOperation(*impl_, std::optional<std::vector<std::byte>>{}, [this, name] {
-        return impl_->retrieveSecretBytes(name);
-    });
+    return reportResult(*impl_, tryRetrieveSecretBytes(name));
+}
+
+std::optional<std::size_t> SafeKeeping::retrieveSecretInto(std::string_view name, std::span<std::byte> out) const {
+    return reportResult(*impl_, tryRetrieveSecretInto(name, out));
+}
+
+std::optional<SecureBuffer> SafeKeeping::retrieveSecretSecure(std::string_view name) const {
+    return reportResult(*impl_, tryRetrieveSecretSecure(name));
 }
 
 bool SafeKeeping::removeSecret(std::string_view name) {
-    return runBoolOperation(*impl_, [this, name] {
-        return impl_->removeSecret(name);
+    return reportResult(*impl_, tryRemoveSecret(name));
+}
+
+struct SafeKeeping::SecretWriter::State {
+    SafeKeeping::Impl* impl = nullptr;
+    std::string name;
+    std::optional<std::string> description;
+    StreamManifest manifest;
+    // The pending chunk. It is only stored once more data arrives, so the
+    // chunk left here at commit() is always the last one.
+    GuardedBytes buffer{kStreamChunkSize};
+    std::size_t buffered = 0;
+    std::uint64_t storedChunks = 0;
+    std::uint64_t written = 0;
+    bool committed = false;
+};
+
+SafeKeeping::SecretWriter::SecretWriter(std::unique_ptr<State> state)
+    : state_(std::move(state)) {}
+
+SafeKeeping::SecretWriter::~SecretWriter() {
+    if (!state_->committed && state_->storedChunks > 0) {
+        try {
+            state_->impl->discardStream(state_->manifest);
+        } catch (...) {
+            // Leftover chunks are unreachable ciphertext; never throw here.
+        }
+    }
+}
+
+bool SafeKeeping::SecretWriter::write(std::span<const std::byte> data) {
+    auto& state = *state_;
+    return runBoolOperation(*state.impl, [&state, data] {
+        if (state.committed) {
+            fail(Error::InvalidArgument, "secret writer is already committed");
+        }
+        auto remaining = data;
+        while (!remaining.empty()) {
+            if (state.buffered == kStreamChunkSize) {
+                state.impl->writeStreamChunk(state.manifest,
+                                             state.storedChunks,
+                                             {state.buffer.data(), state.buffered});
+                ++state.storedChunks;
+                state.buffered = 0;
+            }
+            const auto count = std::min(remaining.size(), kStreamChunkSize - state.buffered);
+            std::memcpy(state.buffer.data() + state.buffered, remaining.data(), count);
+            state.buffered += count;
+            state.written += count;
+            remaining = remaining.subspan(count);
+        }
+        return true;
+    });
+}
+
+bool SafeKeeping::SecretWriter::write(std::string_view data) {
+    return write(std::as_bytes(std::span(data.data(), data.size())));
+}
+
+bool SafeKeeping::SecretWriter::commit() {
+    auto& state = *state_;
+    return measured(*state.impl, Operation::Store, state.name, [&] {
+        return runBoolOperation(*state.impl, [&state] {
+            if (state.committed) {
+                fail(Error::InvalidArgument, "secret writer is already committed");
+            }
+            auto manifest = state.manifest;
+            manifest.totalSize = state.written;
+            manifest.chunkCount = state.storedChunks + 1;
+            std::optional<std::string_view> description;
+            if (state.description.has_value()) {
+                description = *state.description;
+            }
+            state.impl->commitStream(state.name, description, manifest, {state.buffer.data(), state.buffered});
+            sodium_memzero(state.buffer.data(), state.buffer.size());
+            state.committed = true;
+            return true;
+        });
+    });
+}
+
+std::uint64_t SafeKeeping::SecretWriter::size() const noexcept {
+    return state_->written;
+}
+
+struct SafeKeeping::SecretReader::State {
+    const SafeKeeping::Impl* impl = nullptr;
+    // Set for streamed secrets; inline secrets are held in `value`.
+    std::optional<StreamManifest> manifest;
+    std::vector<std::byte> value;
+    std::uint64_t position = 0;
+    // The most recently decrypted chunk.
+    bytes chunk;
+    std::optional<std::uint64_t> chunkIndex;
+
+    ~State() {
+        sodium_memzero(value.data(), value.size());
+        sodium_memzero(chunk.data(), chunk.size());
+    }
+
+    [[nodiscard]] std::uint64_t size() const noexcept {
+        return manifest.has_value() ? manifest->totalSize : value.size();
+    }
+
+    [[nodiscard]] std::size_t readAt(std::uint64_t offset, std::span<std::byte> out) {
+        std::size_t copied = 0;
+        while (copied < out.size() && offset < size()) {
+            std::span<const unsigned char> source;
+            std::uint64_t within = offset;
+            if (manifest.has_value()) {
+                const auto index = offset / manifest->chunkSize;
+                if (chunkIndex != index) {
+                    sodium_memzero(chunk.data(), chunk.size());
+                    chunkIndex.reset();
+                    chunk = impl->readStreamChunk(*manifest, index);
+                    chunkIndex = index;
+                }
+                source = chunk;
+                within = offset % manifest->chunkSize;
+            } else {
+                source = std::span(reinterpret_cast<const unsigned char*>(value.data()), value.size());
+            }
+            const auto count = std::min(out.size() - copied,
+                                        source.size() - static_cast<std::size_t>(within));
+            std::memcpy(out.data() + copied, source.data() + within, count);
+            copied += count;
+            offset += count;
+        }
+        return copied;
+    }
+};
+
+SafeKeeping::SecretReader::SecretReader(std::unique_ptr<State> state)
+    : state_(std::move(state)) {}
+
+SafeKeeping::SecretReader::~SecretReader() = default;
+
+std::uint64_t SafeKeeping::SecretReader::size() const noexcept {
+    return state_->size();
+}
+
+std::uint64_t SafeKeeping::SecretReader::tell() const noexcept {
+    return state_->position;
+}
+
+bool SafeKeeping::SecretReader::seek(std::uint64_t offset) {
+    auto& state = *state_;
+    return runBoolOperation(*state.impl, [&state, offset] {
+        if (offset > state.size()) {
+            fail(Error::InvalidArgument, "seek offset is past the end of the secret");
+        }
+        state.position = offset;
+        return true;
+    });
+}
+
+std::optional<std::size_t> SafeKeeping::SecretReader::read(std::span<std::byte> out) {
+    auto& state = *state_;
+    return runValueOperation(*state.impl, std::optional<std::size_t>{}, [&state, out] {
+        const auto count = state.readAt(state.position, out);
+        state.position += count;
+        return std::optional<std::size_t>(count);
+    });
+}
+
+std::optional<std::size_t> SafeKeeping::SecretReader::readAt(std::uint64_t offset, std::span<std::byte> out) {
+    auto& state = *state_;
+    return runValueOperation(*state.impl, std::optional<std::size_t>{}, [&state, offset, out] {
+        return std::optional<std::size_t>(state.readAt(offset, out));
+    });
+}
+
+std::unique_ptr<SafeKeeping::SecretWriter> SafeKeeping::openSecretWriter(std::string_view name) {
+    return runValueOperation(*impl_, std::unique_ptr<SecretWriter>{}, [this, name] {
+        auto state = std::make_unique<SecretWriter::State>();
+        state->manifest = impl_->beginStream(name, std::nullopt);
+        state->impl = impl_.get();
+        state->name = std::string(name);
+        return std::unique_ptr<SecretWriter>(new SecretWriter(std::move(state)));
+    });
+}
+
+std::unique_ptr<SafeKeeping::SecretWriter> SafeKeeping::openSecretWriter(std::string_view name,
+                                                                         std::string_view description) {
+    return runValueOperation(*impl_, std::unique_ptr<SecretWriter>{}, [this, name, description] {
+        auto state = std::make_unique<SecretWriter::State>();
+        state->manifest = impl_->beginStream(name, description);
+        state->impl = impl_.get();
+        state->name = std::string(name);
+        state->description = std::string(description);
+        return std::unique_ptr<SecretWriter>(new SecretWriter(std::move(state)));
+    });
+}
+
+std::unique_ptr<SafeKeeping::SecretReader> SafeKeeping::openSecretReader(std::string_view name) const {
+    return measured(*impl_, Operation::Retrieve, name, [&] {
+        return runValueOperation(*impl_, std::unique_ptr<SecretReader>{}, [this, name] {
+            auto stored = impl_->openStream(name);
+            auto state = std::make_unique<SecretReader::State>();
+            state->impl = impl_.get();
+            state->manifest = stored.manifest;
+            state->value = std::move(stored.value);
+            return std::unique_ptr<SecretReader>(new SecretReader(std::move(state)));
+        });
+    });
+}
+
+SafeKeeping::result_t<std::string> SafeKeeping::tryRetrieveSecret(std::string_view name) const {
+    return measured(*impl_, Operation::Retrieve, name, [&] {
+        return runResultOperation<std::string>([this, name] {
+            return impl_->retrieveSecret(name);
+        });
+    });
+}
+
+SafeKeeping::result_t<std::vector<std::byte>> SafeKeeping::tryRetrieveSecretBytes(std::string_view name) const {
+    return measured(*impl_, Operation::Retrieve, name, [&] {
+        return runResultOperation<std::vector<std::byte>>([this, name] {
+            return impl_->retrieveSecretBytes(name);
+        });
+    });
+}
+
+SafeKeeping::result_t<std::size_t> SafeKeeping::tryRetrieveSecretInto(std::string_view name,
+                                                                      std::span<std::byte> out) const {
+    return measured(*impl_, Operation::Retrieve, name, [&] {
+        return runResultOperation<std::size_t>([this, name, out] {
+            return impl_->retrieveSecretInto(name, out);
+        });
+    });
+}
+
+SafeKeeping::result_t<SecureBuffer> SafeKeeping::tryRetrieveSecretSecure(std::string_view name) const {
+    return measured(*impl_, Operation::Retrieve, name, [&] {
+        return runResultOperation<SecureBuffer>([this, name] {
+            return impl_->retrieveSecretSecure(name);
+        });
+    });
+}
+
+SafeKeeping::result_t<void> SafeKeeping::tryStoreSecret(std::string_view name, std::string_view secret) {
+    return tryStoreSecret(name, asByteView(secret));
+}
+
+SafeKeeping::result_t<void> SafeKeeping::tryStoreSecret(std::string_view name,
+                                                        std::span<const std::byte> secret) {
+    return measured(*impl_, Operation::Store, name, [&] {
+        return runResultOperation<void>([this, name, secret] {
+            return impl_->storeSecret(name, secret);
+        });
+    });
+}
+
+SafeKeeping::result_t<void> SafeKeeping::tryRemoveSecret(std::string_view name) {
+    return measured(*impl_, Operation::Remove, name, [&] {
+        return runResultOperation<void>([this, name] {
+            return impl_->removeSecret(name);
+        });
     });
 }
 
 SafeKeeping::info_list_t SafeKeeping::listSecrets() const {
-    return runValueOperation(*impl_, info_list_t{}, [this] {
-        return impl_->listSecrets();
+    return measured(*impl_, Operation::List, [&] {
+        return runValueOperation(*impl_, info_list_t{}, [this] {
+            return impl_->listSecrets();
+        });
+    });
+}
+
+bool SafeKeeping::forEachSecret(const list_visitor_t& visitor) const {
+    return forEachSecret(ListOptions{}, visitor);
+}
+
+bool SafeKeeping::forEachSecret(const ListOptions& options, const list_visitor_t& visitor) const {
+    return measured(*impl_, Operation::List, [&] {
+        return runBoolOperation(*impl_, [this, &options, &visitor] {
+            return impl_->forEachSecret(options, visitor);
+        });
+    });
+}
+
+std::optional<SafeKeeping::ListPage> SafeKeeping::listSecretsPage(const ListOptions& options) const {
+    return measured(*impl_, Operation::List, [&] {
+        return runValueOperation(*impl_, std::optional<ListPage>{}, [this, &options] {
+            return std::optional<ListPage>{impl_->listSecretsPage(options)};
+        });
+    });
+}
+
+void SafeKeeping::enableCache(const CacheOptions& options) {
+    impl_->enableCache(options);
+}
+
+void SafeKeeping::enableCache() {
+    impl_->enableCache(CacheOptions{});
+}
+
+void SafeKeeping::disableCache() {
+    impl_->disableCache();
+}
+
+SafeKeeping::CacheStats SafeKeeping::cacheStats() const {
+    return impl_->cacheStats();
+}
+
+SafeKeeping::Stats SafeKeeping::stats() const {
+    return impl_->stats();
+}
+
+SafeKeeping::Stats SafeKeeping::processStats() {
+    return Impl::processStats();
+}
+
+SafeKeeping::AuditStats SafeKeeping::auditStats() const {
+    return impl_->auditStats();
+}
+
+std::optional<std::vector<SafeKeeping::AuditEvent>> SafeKeeping::readAuditLog() const {
+    return runValueOperation(*impl_, std::optional<std::vector<AuditEvent>>{}, [this] {
+        return std::optional<std::vector<AuditEvent>>{impl_->readAuditLog()};
     });
 }
 
+void SafeKeeping::setScanWorkers(std::size_t workers) {
+    impl_->setScanWorkers(workers);
+}
+
 SafeKeeping::LatestError SafeKeeping::latestError() const {
     return impl_->latestError();
 }
@@ -1978,4 +6407,179 @@ bool SafeKeeping::removeRecoveryKey() {
     });
 }
 
+// Instances report each use with a timestamp, and a reopen through the hook
+// given to SafeKeeping::Impl::manage(). The cap is enforced when an instance
+// is opened or reopened: the open instances are ordered by last use and the
+// oldest idle ones are closed. Victims are only try-locked, so a reopen that
+// runs under its own write lock never waits on another instance.
+class SafeKeepingManager::Impl : public std::enable_shared_from_this<SafeKeepingManager::Impl> {
+public:
+    explicit Impl(Options options) : options_(options) {
+        if (options_.maxOpenDatabases == 0) {
+            throw std::invalid_argument("maxOpenDatabases must be at least 1");
+        }
+    }
+
+    std::shared_ptr<SafeKeeping> get(std::string namespaceName, const SafeKeeping::UnlockOptions& options) {
+        validateNamespaceOrSecretName(namespaceName, "namespace");
+        std::shared_ptr<Entry> entry;
+        {
+            const std::scoped_lock lock(mutex_);
+            auto& slot = entries_[namespaceName];
+            if (!slot) {
+                slot = std::make_shared<Entry>();
+            }
+            entry = slot;
+        }
+
+        // Held while opening, so concurrent first calls share one instance.
+        const std::scoped_lock entryLock(entry->mutex);
+        if (auto handle = entry->handle) {
+            if (!handle->impl_->isUnlocked()) {
+                handle->impl_->unlockRequested(options);
+            }
+            return handle;
+        }
+        std::shared_ptr<SafeKeeping> handle = SafeKeeping::Impl::open(namespaceName, options);
+        const std::scoped_lock lock(mutex_);
+        if (!handle) {
+            if (const auto it = entries_.find(namespaceName); it != entries_.end() && it->second == entry) {
+                entries_.erase(it);
+            }
+            return nullptr;
+        }
+        auto* instance = handle->impl_.get();
+        instance->manage([weak = weak_from_this(), instance] {
+            if (auto self = weak.lock()) {
+                self->reopened(instance);
+            }
+        });
+        entry->handle = handle;
+        enforceCap(instance);
+        return handle;
+    }
+
+    bool release(std::string_view namespaceName) {
+        const std::scoped_lock lock(mutex_);
+        const auto it = entries_.find(namespaceName);
+        if (it == entries_.end()) {
+            return false;
+        }
+        const bool held = it->second->handle != nullptr;
+        entries_.erase(it);
+        return held;
+    }
+
+    std::size_t closeIdle() {
+        const std::scoped_lock lock(mutex_);
+        std::size_t closed = 0;
+        for (const auto& [name, entry] : entries_) {
+            if (entry->handle && entry->handle->impl_->connectionsOpen() &&
+                entry->handle->impl_->closeConnections(!options_.keepUnlocked)) {
+                ++closed;
+            }
+        }
+        return closed;
+    }
+
+    [[nodiscard]] Stats stats() const {
+        const std::scoped_lock lock(mutex_);
+        Stats stats;
+        for (const auto& [name, entry] : entries_) {
+            if (!entry->handle) {
+                continue;
+            }
+            ++stats.namespaces;
+            if (entry->handle->impl_->connectionsOpen()) {
+                ++stats.openDatabases;
+            }
+        }
+        stats.evictions = evictions_;
+        stats.reopens = reopens_;
+        stats.busySkips = busySkips_;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        std::mutex mutex;
+        // Set under both mutexes, so either is enough to read it.
+        std::shared_ptr<SafeKeeping> handle;
+    };
+
+    void reopened(const SafeKeeping::Impl* instance) {
+        const std::scoped_lock lock(mutex_);
+        if (instance->evicted()) {
+            ++reopens_;
+        }
+        enforceCap(instance);
+    }
+
+    // Caller holds mutex_. `keep` is the instance that is being opened.
+    void enforceCap(const SafeKeeping::Impl* keep) {
+        // lastUse() changes under other threads' calls, so sort a snapshot.
+        std::vector<std::pair<std::int64_t, SafeKeeping::Impl*>> open;
+        for (const auto& [name, entry] : entries_) {
+            if (entry->handle && entry->handle->impl_->connectionsOpen()) {
+                auto* const instance = entry->handle->impl_.get();
+                open.emplace_back(instance->lastUse(), instance);
+            }
+        }
+        if (open.size() <= options_.maxOpenDatabases) {
+            return;
+        }
+        std::ranges::sort(open, {}, &std::pair<std::int64_t, SafeKeeping::Impl*>::first);
+        auto excess = open.size() - options_.maxOpenDatabases;
+        for (const auto& [lastUse, instance] : open) {
+            if (excess == 0) {
+                break;
+            }
+            if (instance == keep) {
+                continue;
+            }
+            if (instance->closeConnections(!options_.keepUnlocked)) {
+                ++evictions_;
+                --excess;
+            } else {
+                ++busySkips_;
+            }
+        }
+    }
+
+    const Options options_;
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<Entry>, std::less<>> entries_;
+    std::uint64_t evictions_ = 0;
+    std::uint64_t reopens_ = 0;
+    std::uint64_t busySkips_ = 0;
+};
+
+SafeKeepingManager::SafeKeepingManager()
+    : SafeKeepingManager(Options{}) {}
+
+SafeKeepingManager::SafeKeepingManager(Options options)
+    : impl_(std::make_shared<Impl>(options)) {}
+
+SafeKeepingManager::~SafeKeepingManager() = default;
+
+std::shared_ptr<SafeKeeping> SafeKeepingManager::get(std::string namespaceName) {
+    return impl_->get(std::move(namespaceName), SafeKeeping::UnlockOptions{});
+}
+
+std::shared_ptr<SafeKeeping> SafeKeepingManager::get(std::string namespaceName, SafeKeeping::UnlockOptions options) {
+    return impl_->get(std::move(namespaceName), options);
+}
+
+bool SafeKeepingManager::release(std::string_view namespaceName) {
+    return impl_->release(namespaceName);
+}
+
+std::size_t SafeKeepingManager::closeIdle() {
+    return impl_->closeIdle();
+}
+
+SafeKeepingManager::Stats SafeKeepingManager::stats() const {
+    return impl_->stats();
+}
+
 } // namespace jgaa::safekeeping
@@ -1,12 +1,19 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <optional>
 #include <span>
+#include <stop_token>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifndef _WIN32
@@ -19,6 +26,8 @@
 
 namespace fs = std::filesystem;
 using jgaa::safekeeping::SafeKeeping;
+using jgaa::safekeeping::SafeKeepingManager;
+using jgaa::safekeeping::SecureBuffer;
 
 namespace {
 
@@ -66,6 +75,39 @@ void execSql(const fs::path& dbPath, const char* sql) {
     sqlite3_close(db);
 }
 
+std::int64_t queryInt(const fs::path& dbPath, const char* sql) {
+    sqlite3* db = nullptr;
+    std::int64_t value = -1;
+    if (sqlite3_open_v2(dbPath.string().c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK) {
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+            value = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+    return value;
+}
+
+// Descriptors this process has open on a database and its -wal and -shm
+// files, or -1 where that cannot be seen.
+int openDescriptorCount(const fs::path& dbPath) {
+#ifdef __linux__
+    const auto prefix = fs::weakly_canonical(dbPath).string();
+    int count = 0;
+    std::error_code ignored;
+    for (const auto& entry : fs::directory_iterator("/proc/self/fd", ignored)) {
+        if (fs::read_symlink(entry.path(), ignored).string().starts_with(prefix)) {
+            ++count;
+        }
+    }
+    return count;
+#else
+    (void)dbPath;
+    return -1;
+#endif
+}
+
 } // namespace
 
 class SafeKeepingRebootTest : public ::testing::Test {
@@ -82,6 +124,7 @@ protected:
 
     void TearDown() override {
         SafeKeeping::setLinuxVaultRootName("com.jgaa.SafeKeeping");
+        SafeKeeping::setStoreLayout(SafeKeeping::StoreLayout::PerNamespace);
         unsetEnvVar("SAFEKEEPING_DATA_DIR");
         unsetEnvVar("SAFEKEEPING_TEST_FAKE_VAULT_DIR");
         unsetEnvVar("SAFEKEEPING_DISABLE_SYSTEM_VAULT");
@@ -343,6 +386,1360 @@ TEST_F(SafeKeepingRebootTest, MissingSecretSetsNotFoundError) {
     EXPECT_EQ(created.instance->latestError().error, SafeKeeping::Error::NotFound);
 }
 
+TEST_F(SafeKeepingRebootTest, RepeatedOperationsSurviveFailuresAndRelock) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("repeated_ops", options);
+    ASSERT_NE(created.instance, nullptr);
+
+    for (int round = 0; round < 3; ++round) {
+        EXPECT_FALSE(created.instance->retrieveSecret("missing").has_value());
+        EXPECT_EQ(created.instance->latestError().error, SafeKeeping::Error::NotFound);
+        ASSERT_TRUE(created.instance->storeSecret("token", "value-" + std::to_string(round)));
+        EXPECT_EQ(created.instance->retrieveSecret("token"),
+                  std::optional<std::string>("value-" + std::to_string(round)));
+        EXPECT_EQ(created.instance->listSecrets().size(), 1u);
+
+        ASSERT_TRUE(created.instance->lock());
+        EXPECT_TRUE(created.instance->hasPassphraseSlot());
+        ASSERT_TRUE(created.instance->unlockWithPassphrase("pw"));
+    }
+
+    ASSERT_TRUE(created.instance->removeSecret("token"));
+    EXPECT_FALSE(created.instance->removeSecret("token"));
+    EXPECT_EQ(created.instance->latestError().error, SafeKeeping::Error::NotFound);
+}
+
+TEST_F(SafeKeepingRebootTest, WriteBatchAppliesAllOperationsOrNone) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("write_batch", options);
+    ASSERT_NE(created.instance, nullptr);
+    ASSERT_TRUE(created.instance->storeSecret("old", "value"));
+
+    SafeKeeping::WriteBatch batch;
+    batch.store("alpha", "one")
+        .storeWithDescription("beta", "two", "second")
+        .remove("old");
+    EXPECT_EQ(batch.size(), 3u);
+    ASSERT_TRUE(created.instance->apply(batch));
+    EXPECT_EQ(created.instance->retrieveSecret("alpha"), std::optional<std::string>("one"));
+    EXPECT_EQ(created.instance->retrieveSecret("beta"), std::optional<std::string>("two"));
+    EXPECT_FALSE(created.instance->retrieveSecret("old").has_value());
+
+    SafeKeeping::WriteBatch failing;
+    failing.store("gamma", "three").remove("missing");
+    EXPECT_FALSE(created.instance->apply(failing));
+    EXPECT_EQ(created.instance->latestError().error, SafeKeeping::Error::NotFound);
+    EXPECT_FALSE(created.instance->retrieveSecret("gamma").has_value());
+
+    SafeKeeping::WriteBatch invalid;
+    invalid.store("delta", "four").store("bad/name", "five");
+    EXPECT_FALSE(created.instance->apply(invalid));
+    EXPECT_EQ(created.instance->latestError().error, SafeKeeping::Error::InvalidArgument);
+    EXPECT_FALSE(created.instance->retrieveSecret("delta").has_value());
+
+    const auto listed = created.instance->listSecrets();
+    ASSERT_EQ(listed.size(), 2u);
+    EXPECT_EQ(listed[1].name, "beta");
+    EXPECT_EQ(listed[1].description, "second");
+}
+
+TEST_F(SafeKeepingRebootTest, RetrieveSecretsReportsPerNameResults) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("multi_get", options);
+    ASSERT_NE(created.instance, nullptr);
+
+    SafeKeeping::WriteBatch batch;
+    std::vector<std::string> stored;
+    for (int i = 0; i < 100; ++i) {
+        stored.push_back("key_" + std::to_string(i));
+        batch.store(stored.back(), "value_" + std::to_string(i));
+    }
+    ASSERT_TRUE(created.instance->apply(batch));
+
+    std::vector<std::string_view> names(stored.begin(), stored.end());
+    names.push_back("missing");
+    names.push_back("bad/name");
+    names.push_back("key_7");
+
+    const auto results = created.instance->retrieveSecrets(names);
+    ASSERT_TRUE(results.has_value());
+    ASSERT_EQ(results->size(), names.size());
+    for (int i = 0; i < 100; ++i) {
+        const auto& entry = (*results)[i];
+        EXPECT_EQ(entry.name, stored[i]);
+        ASSERT_EQ(entry.error, SafeKeeping::Error::None);
+        ASSERT_TRUE(entry.value.has_value());
+        EXPECT_EQ(std::string(reinterpret_cast<const char*>(entry.value->data()), entry.value->size()),
+                  "value_" + std::to_string(i));
+    }
+    EXPECT_EQ((*results)[100].error, SafeKeeping::Error::NotFound);
+    EXPECT_FALSE((*results)[100].value.has_value());
+    EXPECT_EQ((*results)[101].error, SafeKeeping::Error::InvalidArgument);
+    EXPECT_EQ((*results)[102].value, (*results)[7].value);
+    EXPECT_EQ(created.instance->latestError().error, SafeKeeping::Error::None);
+
+    ASSERT_TRUE(created.instance->lock());
+    EXPECT_FALSE(created.instance->retrieveSecrets(names).has_value());
+    EXPECT_EQ(created.instance->latestError().error, SafeKeeping::Error::Locked);
+}
+
+TEST_F(SafeKeepingRebootTest, StreamingAndPagedListingCoverEveryEntryOnce) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("paged_listing", options);
+    ASSERT_NE(created.instance, nullptr);
+
+    SafeKeeping::WriteBatch batch;
+    for (int i = 0; i < 25; ++i) {
+        batch.storeWithDescription("key_" + std::to_string(i), "value", "desc_" + std::to_string(i));
+    }
+    ASSERT_TRUE(created.instance->apply(batch));
+
+    std::vector<std::string> streamed;
+    ASSERT_TRUE(created.instance->forEachSecret([&](const SafeKeeping::Info& info) {
+        EXPECT_EQ(info.description, "desc_" + info.name.substr(4));
+        streamed.push_back(info.name);
+        return true;
+    }));
+    EXPECT_EQ(streamed.size(), 25u);
+
+    std::size_t visited = 0;
+    SafeKeeping::ListOptions namesOnly;
+    namesOnly.includeDescriptions = false;
+    ASSERT_TRUE(created.instance->forEachSecret(namesOnly, [&](const SafeKeeping::Info& info) {
+        EXPECT_TRUE(info.description.empty());
+        return ++visited < 3;
+    }));
+    EXPECT_EQ(visited, 3u);
+
+    std::vector<std::string> paged;
+    SafeKeeping::ListOptions pageOptions;
+    pageOptions.limit = 10;
+    int pages = 0;
+    while (true) {
+        const auto page = created.instance->listSecretsPage(pageOptions);
+        ASSERT_TRUE(page.has_value());
+        ++pages;
+        for (const auto& entry : page->entries) {
+            paged.push_back(entry.name);
+        }
+        if (!page->nextCursor.has_value()) {
+            break;
+        }
+        pageOptions.cursor = *page->nextCursor;
+    }
+    EXPECT_EQ(pages, 3);
+    EXPECT_EQ(paged, streamed);
+
+    pageOptions.cursor = "not-a-cursor";
+    EXPECT_FALSE(created.instance->listSecretsPage(pageOptions).has_value());
+    EXPECT_EQ(created.instance->latestError().error, SafeKeeping::Error::InvalidArgument);
+}
+
+TEST_F(SafeKeepingRebootTest, ParallelScansMatchSerialScans) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("parallel_scan", options);
+    ASSERT_NE(created.instance, nullptr);
+
+    SafeKeeping::WriteBatch batch;
+    for (int i = 0; i < 1200; ++i) {
+        batch.storeWithDescription("key_" + std::to_string(i), "value", "desc_" + std::to_string(i));
+    }
+    ASSERT_TRUE(created.instance->apply(batch));
+
+    auto streamedNames = [&] {
+        std::vector<std::string> names;
+        EXPECT_TRUE(created.instance->forEachSecret([&](const SafeKeeping::Info& info) {
+            names.push_back(info.name);
+            return true;
+        }));
+        return names;
+    };
+
+    const auto serialList = created.instance->listSecrets();
+    const auto serialStream = streamedNames();
+
+    created.instance->setScanWorkers(4);
+    const auto parallelList = created.instance->listSecrets();
+    ASSERT_EQ(parallelList.size(), serialList.size());
+    for (std::size_t i = 0; i < serialList.size(); ++i) {
+        EXPECT_EQ(parallelList[i].name, serialList[i].name);
+        EXPECT_EQ(parallelList[i].description, serialList[i].description);
+    }
+    EXPECT_EQ(streamedNames(), serialStream);
+
+    created.instance->setScanWorkers(0);
+    EXPECT_EQ(created.instance->listSecrets().size(), 1200u);
+}
+
+TEST_F(SafeKeepingRebootTest, CacheServesRepeatedReadsAndInvalidatesOnWrite) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("secret_cache", options);
+    ASSERT_NE(created.instance, nullptr);
+    auto& instance = *created.instance;
+
+    ASSERT_TRUE(instance.storeSecret("a", "one"));
+    ASSERT_TRUE(instance.storeSecret("b", "two"));
+    ASSERT_TRUE(instance.storeSecret("c", "three"));
+
+    SafeKeeping::CacheOptions cacheOptions;
+    cacheOptions.maxEntries = 2;
+    instance.enableCache(cacheOptions);
+
+    EXPECT_EQ(instance.retrieveSecret("a"), std::optional<std::string>("one"));
+    EXPECT_EQ(instance.retrieveSecret("a"), std::optional<std::string>("one"));
+    auto stats = instance.cacheStats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.bytes, 3u);
+
+    // Overwrite and remove must never serve the old value.
+    ASSERT_TRUE(instance.storeSecret("a", "uno"));
+    EXPECT_EQ(instance.retrieveSecret("a"), std::optional<std::string>("uno"));
+    ASSERT_TRUE(instance.removeSecret("a"));
+    EXPECT_FALSE(instance.retrieveSecret("a").has_value());
+    EXPECT_EQ(instance.latestError().error, SafeKeeping::Error::NotFound);
+
+    SafeKeeping::WriteBatch batch;
+    ASSERT_TRUE(instance.retrieveSecret("b").has_value());
+    batch.store("b", "deux");
+    ASSERT_TRUE(instance.apply(batch));
+    EXPECT_EQ(instance.retrieveSecret("b"), std::optional<std::string>("deux"));
+
+    // The least recently used entry is evicted at the entry limit.
+    ASSERT_TRUE(instance.retrieveSecret("c").has_value());
+    ASSERT_TRUE(instance.storeSecret("d", "four"));
+    ASSERT_TRUE(instance.retrieveSecret("d").has_value());
+    stats = instance.cacheStats();
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_GE(stats.evictions, 1u);
+
+    ASSERT_TRUE(instance.lock());
+    EXPECT_EQ(instance.cacheStats().entries, 0u);
+    EXPECT_FALSE(instance.retrieveSecret("d").has_value());
+    EXPECT_EQ(instance.latestError().error, SafeKeeping::Error::Locked);
+    ASSERT_TRUE(instance.unlockWithPassphrase("pw"));
+
+    cacheOptions.ttl = std::chrono::milliseconds{1};
+    instance.enableCache(cacheOptions);
+    ASSERT_TRUE(instance.retrieveSecret("d").has_value());
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    const auto before = instance.cacheStats();
+    ASSERT_TRUE(instance.retrieveSecret("d").has_value());
+    EXPECT_EQ(instance.cacheStats().expirations, before.expirations + 1);
+
+    instance.disableCache();
+    EXPECT_EQ(instance.cacheStats().entries, 0u);
+}
+
+TEST_F(SafeKeepingRebootTest, SharedInstanceServesConcurrentReadersAndWriters) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("concurrent_readers", options);
+    ASSERT_NE(created.instance, nullptr);
+    auto& instance = *created.instance;
+
+    constexpr int secretCount = 50;
+    SafeKeeping::WriteBatch batch;
+    for (int i = 0; i < secretCount; ++i) {
+        batch.store("key_" + std::to_string(i), "value_" + std::to_string(i));
+    }
+    ASSERT_TRUE(instance.apply(batch));
+
+    std::atomic<int> readFailures{0};
+    std::atomic<int> writeFailures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int round = 0; round < 100; ++round) {
+                const int i = (round * 7 + t) % secretCount;
+                const auto value = instance.retrieveSecret("key_" + std::to_string(i));
+                if (value != std::optional<std::string>("value_" + std::to_string(i))) {
+                    ++readFailures;
+                }
+                // Each thread only sees its own errors.
+                if (instance.retrieveSecret("missing_" + std::to_string(t)).has_value() ||
+                    instance.latestError().error != SafeKeeping::Error::NotFound) {
+                    ++readFailures;
+                }
+            }
+        });
+    }
+    threads.emplace_back([&] {
+        for (int round = 0; round < 50; ++round) {
+            if (!instance.storeSecret("writer_" + std::to_string(round), "value")) {
+                ++writeFailures;
+            }
+        }
+    });
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(readFailures.load(), 0);
+    EXPECT_EQ(writeFailures.load(), 0);
+    EXPECT_EQ(instance.listSecrets().size(), static_cast<std::size_t>(secretCount + 50));
+    EXPECT_EQ(instance.latestError().error, SafeKeeping::Error::None);
+}
+
+TEST_F(SafeKeepingRebootTest, ResultApiReportsErrorsWithoutTouchingLatestError) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("result_api", options);
+    ASSERT_NE(created.instance, nullptr);
+    auto& instance = *created.instance;
+
+    ASSERT_TRUE(instance.tryStoreSecret("token", "value"));
+    auto value = instance.tryRetrieveSecret("token");
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(*value, "value");
+    auto bytes = instance.tryRetrieveSecretBytes("token");
+    ASSERT_TRUE(bytes);
+    EXPECT_EQ(bytes->size(), 5u);
+
+    // Leave a sentinel error; the try* calls must not overwrite it.
+    EXPECT_FALSE(instance.retrieveSecret("bad name"));
+    ASSERT_EQ(instance.latestError().error, SafeKeeping::Error::InvalidArgument);
+
+    const auto missing = instance.tryRetrieveSecret("missing");
+    ASSERT_FALSE(missing);
+    EXPECT_EQ(missing.error().error, SafeKeeping::Error::NotFound);
+    EXPECT_EQ(instance.tryRemoveSecret("missing").error().error, SafeKeeping::Error::NotFound);
+    EXPECT_EQ(instance.tryRetrieveSecret("bad name").error().error, SafeKeeping::Error::InvalidArgument);
+    EXPECT_EQ(instance.tryStoreSecret("big", std::string(10241, 'x')).error().error,
+              SafeKeeping::Error::TooLarge);
+    EXPECT_EQ(instance.tryRetrieveSecret("missing").value_or("fallback"), "fallback");
+    EXPECT_EQ(instance.latestError().error, SafeKeeping::Error::InvalidArgument);
+
+    EXPECT_TRUE(instance.tryRemoveSecret("token"));
+    ASSERT_TRUE(instance.lock());
+    EXPECT_EQ(instance.tryRetrieveSecret("token").error().error, SafeKeeping::Error::Locked);
+    EXPECT_EQ(instance.tryStoreSecret("token", "value").error().error, SafeKeeping::Error::Locked);
+
+    // The bool/optional wrappers still report through latestError().
+    EXPECT_FALSE(instance.removeSecret("token"));
+    EXPECT_EQ(instance.latestError().error, SafeKeeping::Error::Locked);
+}
+
+TEST_F(SafeKeepingRebootTest, DeferredDurabilityGroupsWritesUntilFlush) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    options.open.durability = SafeKeeping::Durability::Deferred;
+    options.open.groupCommitWindow = std::chrono::hours{1};
+    auto created = SafeKeeping::createNew("deferred_writes", options);
+    ASSERT_NE(created.instance, nullptr);
+    auto& writer = *created.instance;
+
+    SafeKeeping::UnlockOptions unlockOptions;
+    unlockOptions.trySystemVaultFirst = false;
+    unlockOptions.passphrase = std::string("pw");
+    auto observer = SafeKeeping::open("deferred_writes", unlockOptions);
+    ASSERT_NE(observer, nullptr);
+    ASSERT_TRUE(observer->isUnlocked());
+
+    // Pending writes are visible to the writing instance only.
+    ASSERT_TRUE(writer.storeSecret("a", "one"));
+    EXPECT_EQ(writer.retrieveSecret("a"), std::optional<std::string>("one"));
+    EXPECT_EQ(writer.listSecrets().size(), 1u);
+    EXPECT_FALSE(observer->retrieveSecret("a").has_value());
+
+    // A failed unit inside the group only undoes itself.
+    SafeKeeping::WriteBatch batch;
+    batch.store("b", "two").remove("missing");
+    EXPECT_FALSE(writer.apply(batch));
+    ASSERT_TRUE(writer.storeSecret("c", "three"));
+
+    ASSERT_TRUE(writer.flush());
+    EXPECT_EQ(observer->retrieveSecret("a"), std::optional<std::string>("one"));
+    EXPECT_FALSE(observer->retrieveSecret("b").has_value());
+    EXPECT_EQ(observer->retrieveSecret("c"), std::optional<std::string>("three"));
+
+    ASSERT_TRUE(writer.storeSecret("d", "four"));
+    ASSERT_TRUE(writer.lock());
+    EXPECT_EQ(observer->retrieveSecret("d"), std::optional<std::string>("four"));
+
+    ASSERT_TRUE(writer.unlockWithPassphrase("pw"));
+    ASSERT_TRUE(writer.storeSecret("e", "five"));
+    created.instance.reset();
+    EXPECT_EQ(observer->retrieveSecret("e"), std::optional<std::string>("five"));
+}
+
+TEST_F(SafeKeepingRebootTest, DeferredDurabilityCommitsAfterTheWindow) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    options.open.durability = SafeKeeping::Durability::Deferred;
+    options.open.groupCommitWindow = std::chrono::milliseconds{20};
+    auto created = SafeKeeping::createNew("deferred_window", options);
+    ASSERT_NE(created.instance, nullptr);
+
+    SafeKeeping::UnlockOptions unlockOptions;
+    unlockOptions.trySystemVaultFirst = false;
+    unlockOptions.passphrase = std::string("pw");
+    unlockOptions.open.durability = SafeKeeping::Durability::Normal;
+    auto observer = SafeKeeping::open("deferred_window", unlockOptions);
+    ASSERT_NE(observer, nullptr);
+
+    ASSERT_TRUE(created.instance->storeSecret("token", "value"));
+    bool visible = false;
+    for (int attempt = 0; attempt < 200 && !visible; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        visible = observer->retrieveSecret("token").has_value();
+    }
+    EXPECT_TRUE(visible);
+
+    // Normal durability still commits each write immediately.
+    ASSERT_TRUE(observer->storeSecret("other", "value"));
+    EXPECT_EQ(created.instance->retrieveSecret("other"), std::optional<std::string>("value"));
+}
+
+TEST_F(SafeKeepingRebootTest, StreamedSecretsRoundTripBeyondTheInlineLimit) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("streamed", options);
+    ASSERT_NE(created.instance, nullptr);
+    auto& safe = *created.instance;
+    const auto dbPath = namespaceDbPath(root_, "streamed");
+    const auto chunkCount = [&dbPath] {
+        return queryInt(dbPath, "SELECT COUNT(*) FROM secret_chunks");
+    };
+
+    std::vector<std::byte> large(200 * 1024);
+    for (std::size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<std::byte>((i * 31) % 251);
+    }
+
+    auto writer = safe.openSecretWriter("big", "a large blob");
+    ASSERT_NE(writer, nullptr);
+    const std::span<const std::byte> all(large);
+    ASSERT_TRUE(writer->write(all.first(1000)));
+    ASSERT_TRUE(writer->write(all.subspan(1000, 100000)));
+    ASSERT_TRUE(writer->write(all.subspan(101000)));
+    EXPECT_EQ(writer->size(), large.size());
+    ASSERT_TRUE(writer->commit());
+    EXPECT_FALSE(writer->commit());
+    writer.reset();
+    EXPECT_EQ(chunkCount(), 4);
+
+    EXPECT_FALSE(safe.retrieveSecret("big").has_value());
+    EXPECT_EQ(safe.latestError().error, SafeKeeping::Error::TooLarge);
+    const auto listed = safe.listSecrets();
+    ASSERT_EQ(listed.size(), 1u);
+    EXPECT_EQ(listed.front().description, std::optional<std::string>("a large blob"));
+
+    auto reader = safe.openSecretReader("big");
+    ASSERT_NE(reader, nullptr);
+    EXPECT_EQ(reader->size(), large.size());
+    std::vector<std::byte> readBack;
+    std::vector<std::byte> buffer(10000);
+    while (true) {
+        const auto count = reader->read(buffer);
+        ASSERT_TRUE(count.has_value());
+        if (*count == 0) {
+            break;
+        }
+        readBack.insert(readBack.end(), buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(*count));
+    }
+    EXPECT_EQ(readBack, large);
+    EXPECT_EQ(reader->tell(), large.size());
+
+    // Ranged reads across a chunk boundary and at the end.
+    std::vector<std::byte> range(20);
+    EXPECT_EQ(reader->readAt(64 * 1024 - 10, range), std::optional<std::size_t>(20));
+    EXPECT_TRUE(std::equal(range.begin(), range.end(), large.begin() + (64 * 1024 - 10)));
+    EXPECT_EQ(reader->readAt(large.size() - 5, range), std::optional<std::size_t>(5));
+    EXPECT_EQ(reader->readAt(large.size(), range), std::optional<std::size_t>(0));
+    EXPECT_FALSE(reader->seek(large.size() + 1));
+    ASSERT_TRUE(reader->seek(0));
+    EXPECT_EQ(reader->tell(), 0u);
+
+    // Replacing the secret drops its chunks; an open reader then fails on
+    // chunks it has not loaded yet.
+    writer = safe.openSecretWriter("big");
+    ASSERT_NE(writer, nullptr);
+    ASSERT_TRUE(writer->write("small now"));
+    ASSERT_TRUE(writer->commit());
+    writer.reset();
+    EXPECT_EQ(chunkCount(), 1);
+    EXPECT_EQ(safe.retrieveSecret("big"), std::optional<std::string>("small now"));
+    EXPECT_FALSE(reader->readAt(0, range).has_value());
+    EXPECT_EQ(safe.latestError().error, SafeKeeping::Error::NotFound);
+    reader.reset();
+
+    ASSERT_TRUE(safe.storeSecret("inline", "plain"));
+    reader = safe.openSecretReader("inline");
+    ASSERT_NE(reader, nullptr);
+    EXPECT_EQ(reader->readAt(1, range), std::optional<std::size_t>(4));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(range.data()), 4), "lain");
+    reader.reset();
+
+    // An abandoned writer leaves nothing behind.
+    writer = safe.openSecretWriter("abandoned");
+    ASSERT_NE(writer, nullptr);
+    ASSERT_TRUE(writer->write(all));
+    writer.reset();
+    EXPECT_EQ(chunkCount(), 1);
+    EXPECT_FALSE(safe.openSecretReader("abandoned"));
+    EXPECT_EQ(safe.latestError().error, SafeKeeping::Error::NotFound);
+
+    ASSERT_TRUE(safe.removeSecret("big"));
+    EXPECT_EQ(chunkCount(), 0);
+    EXPECT_FALSE(safe.openSecretWriter("bad name!"));
+    EXPECT_EQ(safe.latestError().error, SafeKeeping::Error::InvalidArgument);
+}
+
+TEST_F(SafeKeepingRebootTest, RetrievesIntoCallerAndSecureBuffers) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("into_buffers", options);
+    ASSERT_NE(created.instance, nullptr);
+    auto& safe = *created.instance;
+    ASSERT_TRUE(safe.storeSecret("token", "0123456789"));
+    ASSERT_TRUE(safe.storeSecret("empty", ""));
+
+    const auto asText = [](std::span<const std::byte> value) {
+        return std::string(reinterpret_cast<const char*>(value.data()), value.size());
+    };
+
+    // Run twice: first from the database, then from the cache.
+    safe.enableCache();
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<std::byte> buffer(32, std::byte{'#'});
+        EXPECT_EQ(safe.retrieveSecretInto("token", buffer), std::optional<std::size_t>(10));
+        EXPECT_EQ(asText(std::span(buffer).first(11)), "0123456789#");
+
+        std::vector<std::byte> small(9, std::byte{'#'});
+        EXPECT_FALSE(safe.retrieveSecretInto("token", small).has_value());
+        EXPECT_EQ(safe.latestError().error, SafeKeeping::Error::TooLarge);
+        EXPECT_EQ(asText(small), "#########");
+
+        const auto secure = safe.retrieveSecretSecure("token");
+        ASSERT_TRUE(secure.has_value());
+        EXPECT_EQ(secure->view(), "0123456789");
+        EXPECT_EQ(safe.retrieveSecretInto("empty", small), std::optional<std::size_t>(0));
+        const auto empty = safe.tryRetrieveSecretSecure("empty");
+        ASSERT_TRUE(empty.has_value());
+        EXPECT_TRUE(empty->empty());
+    }
+    EXPECT_GE(safe.cacheStats().hits, 4u);
+
+    const auto missing = safe.tryRetrieveSecretInto("missing", {});
+    ASSERT_FALSE(missing.has_value());
+    EXPECT_EQ(missing.error().error, SafeKeeping::Error::NotFound);
+
+    // Streamed secrets above the inline limit are returned whole.
+    std::string large(100 * 1024, 'z');
+    large.back() = '!';
+    auto writer = safe.openSecretWriter("large");
+    ASSERT_NE(writer, nullptr);
+    ASSERT_TRUE(writer->write(large));
+    ASSERT_TRUE(writer->commit());
+    writer.reset();
+    const auto secureLarge = safe.retrieveSecretSecure("large");
+    ASSERT_TRUE(secureLarge.has_value());
+    EXPECT_EQ(secureLarge->view(), large);
+    std::vector<std::byte> largeBuffer(large.size());
+    EXPECT_EQ(safe.retrieveSecretInto("large", largeBuffer), std::optional<std::size_t>(large.size()));
+    EXPECT_EQ(asText(largeBuffer), large);
+
+    SecureBuffer moved = std::move(*safe.retrieveSecretSecure("token"));
+    EXPECT_EQ(moved.view(), "0123456789");
+    moved = SecureBuffer(4);
+    EXPECT_EQ(moved.size(), 4u);
+
+    ASSERT_TRUE(safe.lock());
+    EXPECT_FALSE(safe.retrieveSecretSecure("token").has_value());
+    EXPECT_EQ(safe.latestError().error, SafeKeeping::Error::Locked);
+}
+
+TEST_F(SafeKeepingRebootTest, VersionOneDatabaseIsMigratedOnOpen) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    {
+        auto created = SafeKeeping::createNew("schema_v1", options);
+        ASSERT_NE(created.instance, nullptr);
+        ASSERT_TRUE(created.instance->storeSecret("kept", "value"));
+    }
+    const auto dbPath = namespaceDbPath(root_, "schema_v1");
+    execSql(dbPath,
+            "DROP TABLE secret_chunks;"
+            "ALTER TABLE secrets DROP COLUMN stream_id;"
+            "UPDATE metadata SET schema_version = 1;");
+
+    SafeKeeping::UnlockOptions unlockOptions;
+    unlockOptions.trySystemVaultFirst = false;
+    unlockOptions.passphrase = std::string("pw");
+    auto reopened = SafeKeeping::open("schema_v1", unlockOptions);
+    ASSERT_NE(reopened, nullptr);
+    EXPECT_EQ(reopened->retrieveSecret("kept"), std::optional<std::string>("value"));
+    EXPECT_EQ(queryInt(dbPath, "SELECT schema_version FROM metadata"), 2);
+
+    auto writer = reopened->openSecretWriter("streamed");
+    ASSERT_NE(writer, nullptr);
+    ASSERT_TRUE(writer->write("after migration"));
+    ASSERT_TRUE(writer->commit());
+    EXPECT_EQ(reopened->retrieveSecret("streamed"), std::optional<std::string>("after migration"));
+}
+
+TEST_F(SafeKeepingRebootTest, AsyncOpenAndUnlockSupportCancellation) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    {
+        auto created = SafeKeeping::createNew("async_unlock", options);
+        ASSERT_NE(created.instance, nullptr);
+        ASSERT_TRUE(created.instance->storeSecret("k", "v"));
+    }
+
+    SafeKeeping::UnlockOptions unlockOptions;
+    unlockOptions.trySystemVaultFirst = false;
+    unlockOptions.passphrase = std::string("pw");
+    auto opened = SafeKeeping::openAsync("async_unlock", unlockOptions).get();
+    ASSERT_TRUE(opened.has_value());
+    ASSERT_TRUE((*opened)->isUnlocked());
+    EXPECT_EQ((*opened)->retrieveSecret("k"), std::optional<std::string>("v"));
+    opened->reset();
+
+    const auto missing = SafeKeeping::openAsync("async_missing", unlockOptions).get();
+    ASSERT_FALSE(missing.has_value());
+    EXPECT_EQ(missing.error().error, SafeKeeping::Error::NotFound);
+
+    std::stop_source cancelled;
+    cancelled.request_stop();
+    const auto cancelledOpen = SafeKeeping::openAsync("async_unlock", unlockOptions, cancelled.get_token()).get();
+    ASSERT_FALSE(cancelledOpen.has_value());
+    EXPECT_EQ(cancelledOpen.error().error, SafeKeeping::Error::Cancelled);
+
+    auto safe = SafeKeeping::open("async_unlock");
+    ASSERT_NE(safe, nullptr);
+    ASSERT_FALSE(safe->isUnlocked());
+
+    SafeKeeping::UnlockOptions wrong;
+    wrong.trySystemVaultFirst = false;
+    wrong.passphrase = std::string("nope");
+    const auto failed = safe->unlockAsync(wrong).get();
+    ASSERT_FALSE(failed.has_value());
+    EXPECT_EQ(failed.error().error, SafeKeeping::Error::UnlockFailed);
+
+    const auto cancelledUnlock = safe->unlockAsync(unlockOptions, cancelled.get_token()).get();
+    ASSERT_FALSE(cancelledUnlock.has_value());
+    EXPECT_EQ(cancelledUnlock.error().error, SafeKeeping::Error::Cancelled);
+    EXPECT_FALSE(safe->isUnlocked());
+
+    // The callback form may destroy the instance it was started on.
+    std::promise<bool> unlocked;
+    safe->unlockAsync(unlockOptions, [&safe, &unlocked](SafeKeeping::result_t<void> result) {
+        const bool ok = result.has_value() && safe->isUnlocked() &&
+            safe->retrieveSecret("k") == std::optional<std::string>("v");
+        safe.reset();
+        unlocked.set_value(ok);
+    });
+    EXPECT_TRUE(unlocked.get_future().get());
+    EXPECT_EQ(safe, nullptr);
+
+    // Destroying an instance waits for its pending calls.
+    safe = SafeKeeping::open("async_unlock");
+    ASSERT_NE(safe, nullptr);
+    auto pending = safe->unlockAsync(unlockOptions);
+    safe.reset();
+    EXPECT_TRUE(pending.get().has_value());
+}
+
+TEST_F(SafeKeepingRebootTest, ParallelUnlockAttemptsPickAnyWorkingMethod) {
+    SafeKeeping::CreateOptions options;
+    options.passphrase = std::string("pw");
+    options.createRecoveryKey = true;
+    auto created = SafeKeeping::createNew("parallel_unlock", options);
+    ASSERT_NE(created.instance, nullptr);
+    ASSERT_TRUE(created.recoveryKey.has_value());
+    EXPECT_TRUE(created.instance->hasSystemVaultSlot());
+    EXPECT_TRUE(created.instance->hasPassphraseSlot());
+    EXPECT_TRUE(created.instance->hasRecoverySlot());
+    ASSERT_TRUE(created.instance->storeSecret("k", "v"));
+    const auto recoveryKey = *created.recoveryKey;
+    created.instance.reset();
+
+    // Each slot written by the parallel derivations unlocks on its own.
+    SafeKeeping::UnlockOptions recoveryOnly;
+    recoveryOnly.trySystemVaultFirst = false;
+    recoveryOnly.passphrase = std::string("wrong");
+    recoveryOnly.recoveryKey = recoveryKey;
+    auto safe = SafeKeeping::open("parallel_unlock", recoveryOnly);
+    ASSERT_NE(safe, nullptr);
+    EXPECT_TRUE(safe->isUnlocked());
+    EXPECT_EQ(safe->latestError().error, SafeKeeping::Error::None);
+    EXPECT_EQ(safe->retrieveSecret("k"), std::optional<std::string>("v"));
+
+    SafeKeeping::UnlockOptions everything;
+    everything.passphrase = std::string("pw");
+    everything.recoveryKey = recoveryKey;
+    safe.reset();
+    const auto before = SafeKeeping::processStats();
+    safe = SafeKeeping::open("parallel_unlock", everything);
+    ASSERT_NE(safe, nullptr);
+    EXPECT_TRUE(safe->isUnlocked());
+    // The vault answered within its head start, so no key was derived. The
+    // reset waits for any method still running.
+    safe.reset();
+    const auto after = SafeKeeping::processStats();
+    const auto started = [&](SafeKeeping::Operation operation) {
+        return after.operation(operation).count - before.operation(operation).count;
+    };
+    EXPECT_EQ(started(SafeKeeping::Operation::UnlockSystemVault), 1U);
+    EXPECT_EQ(started(SafeKeeping::Operation::UnlockPassphrase), 0U);
+    EXPECT_EQ(started(SafeKeeping::Operation::UnlockRecoveryKey), 0U);
+    safe = SafeKeeping::open("parallel_unlock", everything);
+    ASSERT_NE(safe, nullptr);
+
+    // With every method failing, the recovery key's failure is reported.
+    fs::remove_all(vaultRoot_);
+    SafeKeeping::UnlockOptions wrong;
+    wrong.passphrase = std::string("wrong");
+    wrong.recoveryKey = std::string("AAAA-BBBB");
+    safe = SafeKeeping::open("parallel_unlock", wrong);
+    ASSERT_NE(safe, nullptr);
+    EXPECT_FALSE(safe->isUnlocked());
+    EXPECT_EQ(safe->latestError().error, SafeKeeping::Error::UnlockFailed);
+    EXPECT_NE(safe->latestError().message.find("recovery"), std::string::npos);
+
+    ASSERT_TRUE(safe->unlockWithPassphrase("pw"));
+    const auto rotated = safe->rotateRecoveryKey();
+    ASSERT_TRUE(rotated.has_value());
+    EXPECT_TRUE(safe->changePassphrase("pw2"));
+    safe.reset();
+
+    SafeKeeping::UnlockOptions rotatedOptions;
+    rotatedOptions.trySystemVaultFirst = false;
+    rotatedOptions.recoveryKey = *rotated;
+    safe = SafeKeeping::open("parallel_unlock", rotatedOptions);
+    ASSERT_NE(safe, nullptr);
+    EXPECT_TRUE(safe->isUnlocked());
+}
+
+TEST_F(SafeKeepingRebootTest, KdfProfilesApplyToNewSlotsAndRewrapOnUnlock) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    options.createRecoveryKey = true;
+    options.open.kdf = SafeKeeping::KdfOptions{.profile = SafeKeeping::KdfProfile::Minimal};
+    auto created = SafeKeeping::createNew("kdf_profiles", options);
+    ASSERT_NE(created.instance, nullptr);
+    ASSERT_TRUE(created.recoveryKey.has_value());
+    const auto recoveryKey = *created.recoveryKey;
+    created.instance.reset();
+
+    const auto dbPath = namespaceDbPath(root_, "kdf_profiles");
+    const auto opslimit = [&dbPath](std::string_view slotType) {
+        const auto sql = "SELECT kdf_opslimit FROM key_slots WHERE slot_type = '" + std::string(slotType) + "'";
+        return queryInt(dbPath, sql.c_str());
+    };
+    const auto memlimit = [&dbPath](std::string_view slotType) {
+        const auto sql = "SELECT kdf_memlimit FROM key_slots WHERE slot_type = '" + std::string(slotType) + "'";
+        return queryInt(dbPath, sql.c_str());
+    };
+    EXPECT_EQ(opslimit("passphrase"), 1);
+    EXPECT_EQ(memlimit("passphrase"), 8192);
+    EXPECT_EQ(opslimit("recovery"), 1);
+
+    // Without a KDF profile, unlocking leaves the slots alone.
+    SafeKeeping::UnlockOptions unlockOptions;
+    unlockOptions.trySystemVaultFirst = false;
+    unlockOptions.passphrase = std::string("pw");
+    auto safe = SafeKeeping::open("kdf_profiles", unlockOptions);
+    ASSERT_NE(safe, nullptr);
+    ASSERT_TRUE(safe->isUnlocked());
+    safe.reset();
+    EXPECT_EQ(opslimit("passphrase"), 1);
+
+    // Only the slot whose secret was right is rewrapped. Destroying the
+    // instance waits for the background rewrap.
+    SafeKeeping::UnlockOptions mixed;
+    mixed.trySystemVaultFirst = false;
+    mixed.passphrase = std::string("wrong");
+    mixed.recoveryKey = recoveryKey;
+    mixed.open.kdf = SafeKeeping::KdfOptions{};
+    safe = SafeKeeping::open("kdf_profiles", mixed);
+    ASSERT_NE(safe, nullptr);
+    ASSERT_TRUE(safe->isUnlocked());
+    safe.reset();
+    EXPECT_EQ(opslimit("passphrase"), 1);
+    EXPECT_EQ(opslimit("recovery"), 2);
+    EXPECT_EQ(memlimit("recovery"), 67108864);
+
+    unlockOptions.open.kdf = SafeKeeping::KdfOptions{};
+    safe = SafeKeeping::open("kdf_profiles", unlockOptions);
+    ASSERT_NE(safe, nullptr);
+    ASSERT_TRUE(safe->isUnlocked());
+    safe.reset();
+    EXPECT_EQ(opslimit("passphrase"), 2);
+    EXPECT_EQ(memlimit("passphrase"), 67108864);
+
+    // The rewrapped slots still unlock.
+    unlockOptions.open.kdf.reset();
+    safe = SafeKeeping::open("kdf_profiles", unlockOptions);
+    ASSERT_NE(safe, nullptr);
+    EXPECT_TRUE(safe->isUnlocked());
+    EXPECT_TRUE(safe->unlockWithRecoveryKey(recoveryKey));
+
+    // Calibration never drops below the interactive cost.
+    SafeKeeping::CreateOptions calibrated;
+    calibrated.createSystemVaultSlot = false;
+    calibrated.passphrase = std::string("pw");
+    calibrated.open.kdf = SafeKeeping::KdfOptions{.profile = SafeKeeping::KdfProfile::Calibrated,
+                                                  .targetLatency = std::chrono::milliseconds{1}};
+    ASSERT_NE(SafeKeeping::createNew("kdf_calibrated", calibrated).instance, nullptr);
+    EXPECT_GE(queryInt(namespaceDbPath(root_, "kdf_calibrated"),
+                       "SELECT kdf_opslimit FROM key_slots WHERE slot_type = 'passphrase'"),
+              2);
+}
+
+TEST_F(SafeKeepingRebootTest, CalibratedKdfOnlyRewrapsCheaperSlots) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    options.open.kdf = SafeKeeping::KdfOptions{.profile = SafeKeeping::KdfProfile::Calibrated,
+                                               .targetLatency = std::chrono::milliseconds{200}};
+    ASSERT_NE(SafeKeeping::createNew("kdf_calibrated_band", options).instance, nullptr);
+    const auto dbPath = namespaceDbPath(root_, "kdf_calibrated_band");
+    const char* const saltSql = "SELECT hex(kdf_salt) FROM key_slots WHERE slot_type = 'passphrase'";
+    const auto slotSalt = [&dbPath, saltSql] {
+        sqlite3* db = nullptr;
+        std::string salt;
+        if (sqlite3_open_v2(dbPath.string().c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK) {
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v2(db, saltSql, -1, &stmt, nullptr) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+                salt = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            }
+            sqlite3_finalize(stmt);
+        }
+        sqlite3_close(db);
+        return salt;
+    };
+    const auto opslimit = queryInt(dbPath, "SELECT kdf_opslimit FROM key_slots WHERE slot_type = 'passphrase'");
+    const auto salt = slotSalt();
+    ASSERT_FALSE(salt.empty());
+
+    // A new measurement, here with a cheaper target, leaves the slot as is:
+    // no new derivation and no new salt.
+    SafeKeeping::UnlockOptions unlock;
+    unlock.trySystemVaultFirst = false;
+    unlock.passphrase = std::string("pw");
+    for (const auto latency : {std::chrono::milliseconds{200}, std::chrono::milliseconds{1}}) {
+        unlock.open.kdf = SafeKeeping::KdfOptions{.profile = SafeKeeping::KdfProfile::Calibrated,
+                                                  .targetLatency = latency};
+        auto safe = SafeKeeping::open("kdf_calibrated_band", unlock);
+        ASSERT_NE(safe, nullptr);
+        ASSERT_TRUE(safe->isUnlocked());
+        safe.reset();
+        EXPECT_EQ(queryInt(dbPath, "SELECT kdf_opslimit FROM key_slots WHERE slot_type = 'passphrase'"), opslimit);
+        EXPECT_EQ(slotSalt(), salt);
+    }
+
+    // A slot below the calibrated cost is still raised to it.
+    unlock.open.kdf = SafeKeeping::KdfOptions{.profile = SafeKeeping::KdfProfile::Minimal};
+    ASSERT_NE(SafeKeeping::open("kdf_calibrated_band", unlock), nullptr);
+    ASSERT_EQ(queryInt(dbPath, "SELECT kdf_memlimit FROM key_slots WHERE slot_type = 'passphrase'"), 8192);
+    unlock.open.kdf = SafeKeeping::KdfOptions{.profile = SafeKeeping::KdfProfile::Calibrated,
+                                              .targetLatency = std::chrono::milliseconds{1}};
+    ASSERT_NE(SafeKeeping::open("kdf_calibrated_band", unlock), nullptr);
+    EXPECT_EQ(queryInt(dbPath, "SELECT kdf_memlimit FROM key_slots WHERE slot_type = 'passphrase'"), 67108864);
+}
+
+TEST_F(SafeKeepingRebootTest, SharedHandlesShareOneUnlockedInstance) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    ASSERT_NE(SafeKeeping::createNew("shared_handles", options).instance, nullptr);
+
+    EXPECT_EQ(SafeKeeping::openShared("missing_shared"), nullptr);
+
+    SafeKeeping::UnlockOptions unlockOptions;
+    unlockOptions.trySystemVaultFirst = false;
+    unlockOptions.passphrase = std::string("pw");
+    auto first = SafeKeeping::openShared("shared_handles", unlockOptions);
+    ASSERT_NE(first, nullptr);
+    ASSERT_TRUE(first->isUnlocked());
+    ASSERT_TRUE(first->storeSecret("k", "v"));
+
+    // A second component gets the same unlocked instance without credentials.
+    auto second = SafeKeeping::openShared("shared_handles");
+    EXPECT_EQ(second, first);
+    EXPECT_TRUE(second->isUnlocked());
+    EXPECT_EQ(second->retrieveSecret("k"), std::optional<std::string>("v"));
+
+    auto plain = SafeKeeping::open("shared_handles", unlockOptions);
+    ASSERT_NE(plain, nullptr);
+    ASSERT_TRUE(plain->isUnlocked());
+
+    EXPECT_EQ(SafeKeeping::lockAll(), 2U);
+    EXPECT_FALSE(first->isUnlocked());
+    EXPECT_FALSE(plain->isUnlocked());
+    EXPECT_EQ(SafeKeeping::lockAll(), 0U);
+
+    // Credentials given to a later open unlock the shared instance again.
+    unlockOptions.passphrase = std::string("wrong");
+    EXPECT_EQ(SafeKeeping::openShared("shared_handles", unlockOptions), first);
+    EXPECT_FALSE(first->isUnlocked());
+    EXPECT_EQ(first->latestError().error, SafeKeeping::Error::UnlockFailed);
+    unlockOptions.passphrase = std::string("pw");
+    EXPECT_EQ(SafeKeeping::openShared("shared_handles", unlockOptions), first);
+    EXPECT_TRUE(first->isUnlocked());
+
+    // Once every handle is gone, the next call opens a fresh instance.
+    first.reset();
+    second.reset();
+    auto reopened = SafeKeeping::openShared("shared_handles");
+    ASSERT_NE(reopened, nullptr);
+    EXPECT_FALSE(reopened->isUnlocked());
+}
+
+TEST_F(SafeKeepingRebootTest, PrefetchedVaultMaterialServesTheNextUnlock) {
+    const std::vector<std::string> names{"prefetch_a", "prefetch_b", "prefetch_c"};
+    SafeKeeping::CreateOptions options;
+    options.passphrase = std::string("pw");
+    for (const auto& name : names) {
+        auto created = SafeKeeping::createNew(name, options);
+        ASSERT_NE(created.instance, nullptr);
+        ASSERT_TRUE(created.instance->storeSecret("k", name));
+    }
+
+    std::vector<std::string> wanted = names;
+    wanted.emplace_back("prefetch_missing");
+    EXPECT_EQ(SafeKeeping::prefetchVaultMaterial(wanted), 3U);
+    EXPECT_THROW(SafeKeeping::prefetchVaultMaterial(std::vector<std::string>{"bad/name"}), std::exception);
+
+    // With the vault gone, only the prefetched material can unlock.
+    fs::remove_all(vaultRoot_);
+    auto first = SafeKeeping::open("prefetch_a");
+    ASSERT_NE(first, nullptr);
+    EXPECT_TRUE(first->isUnlocked());
+    EXPECT_EQ(first->retrieveSecret("k"), std::optional<std::string>("prefetch_a"));
+
+    // Each entry serves one unlock.
+    auto again = SafeKeeping::open("prefetch_a");
+    ASSERT_NE(again, nullptr);
+    EXPECT_FALSE(again->isUnlocked());
+    EXPECT_EQ(again->latestError().error, SafeKeeping::Error::VaultError);
+
+    auto second = SafeKeeping::open("prefetch_b");
+    ASSERT_NE(second, nullptr);
+    EXPECT_TRUE(second->isUnlocked());
+
+    // Removing a namespace drops its prefetched material.
+    EXPECT_TRUE(SafeKeeping::removeNamespace("prefetch_c"));
+    SafeKeeping::CreateOptions recreate;
+    recreate.createSystemVaultSlot = false;
+    recreate.passphrase = std::string("pw");
+    ASSERT_NE(SafeKeeping::createNew("prefetch_c", recreate).instance, nullptr);
+    auto third = SafeKeeping::open("prefetch_c");
+    ASSERT_NE(third, nullptr);
+    ASSERT_TRUE(third->unlockWithPassphrase("pw"));
+    EXPECT_TRUE(third->addSystemVaultSlot());
+    ASSERT_TRUE(third->lock());
+    EXPECT_TRUE(third->unlockWithSystemVault());
+}
+
+TEST_F(SafeKeepingRebootTest, StatsCountOperationsErrorsAndPhases) {
+    using Operation = SafeKeeping::Operation;
+    using Phase = SafeKeeping::Phase;
+
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("metrics", options);
+    ASSERT_NE(created.instance, nullptr);
+    created.instance.reset();
+
+    const auto before = SafeKeeping::processStats();
+    auto safe = SafeKeeping::open("metrics");
+    ASSERT_NE(safe, nullptr);
+    EXPECT_FALSE(safe->unlockWithPassphrase("wrong"));
+    ASSERT_TRUE(safe->unlockWithPassphrase("pw"));
+    ASSERT_TRUE(safe->storeSecret("a", "1"));
+    EXPECT_FALSE(safe->storeSecret("b", std::string(20000, 'x')));
+    EXPECT_EQ(safe->retrieveSecret("a"), std::optional<std::string>("1"));
+    EXPECT_FALSE(safe->tryRetrieveSecret("missing").has_value());
+    EXPECT_EQ(safe->listSecrets().size(), 1U);
+    EXPECT_TRUE(safe->removeSecret("a"));
+
+    const auto stats = safe->stats();
+    EXPECT_EQ(stats.operation(Operation::UnlockPassphrase).count, 2U);
+    EXPECT_EQ(stats.operation(Operation::UnlockPassphrase).errors, 1U);
+    EXPECT_EQ(stats.operation(Operation::Store).count, 2U);
+    EXPECT_EQ(stats.operation(Operation::Store).errors, 1U);
+    EXPECT_EQ(stats.operation(Operation::Retrieve).count, 2U);
+    EXPECT_EQ(stats.operation(Operation::Retrieve).errors, 1U);
+    EXPECT_EQ(stats.operation(Operation::List).count, 1U);
+    EXPECT_EQ(stats.operation(Operation::List).errors, 0U);
+    EXPECT_EQ(stats.operation(Operation::Remove).count, 1U);
+    // open() tried the system vault, which has no slot here.
+    EXPECT_EQ(stats.operation(Operation::UnlockSystemVault).count, 1U);
+    EXPECT_EQ(stats.errorCount(SafeKeeping::Error::UnlockUnavailable), 1U);
+    EXPECT_EQ(stats.errorCount(SafeKeeping::Error::UnlockFailed), 1U);
+    EXPECT_EQ(stats.errorCount(SafeKeeping::Error::TooLarge), 1U);
+    EXPECT_EQ(stats.errorCount(SafeKeeping::Error::NotFound), 1U);
+
+    const auto& unlocks = stats.operation(Operation::UnlockPassphrase);
+    std::uint64_t bucketed = 0;
+    for (const auto count : unlocks.latency) {
+        bucketed += count;
+    }
+    EXPECT_EQ(bucketed, unlocks.count);
+    EXPECT_GT(unlocks.totalTime, std::chrono::nanoseconds::zero());
+
+    EXPECT_GT(stats.phase(Phase::Kdf), std::chrono::nanoseconds::zero());
+    EXPECT_GT(stats.phase(Phase::Aead), std::chrono::nanoseconds::zero());
+    EXPECT_GT(stats.phase(Phase::SqliteStep), std::chrono::nanoseconds::zero());
+    EXPECT_GT(stats.phase(Phase::SqliteCommit), std::chrono::nanoseconds::zero());
+    EXPECT_EQ(stats.phase(Phase::Vault), std::chrono::nanoseconds::zero());
+    EXPECT_GT(stats.sqliteCacheHits + stats.sqliteCacheMisses, 0U);
+
+    // The process aggregate covers this instance's calls.
+    const auto after = SafeKeeping::processStats();
+    EXPECT_EQ(after.operation(Operation::Store).count - before.operation(Operation::Store).count, 2U);
+    EXPECT_EQ(after.errorCount(SafeKeeping::Error::UnlockFailed) - before.errorCount(SafeKeeping::Error::UnlockFailed),
+              1U);
+    EXPECT_GE(after.sqliteCacheHits + after.sqliteCacheMisses, stats.sqliteCacheHits + stats.sqliteCacheMisses);
+}
+
+TEST_F(SafeKeepingRebootTest, AuditLogRecordsAccessEncrypted) {
+    using Operation = SafeKeeping::Operation;
+
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    options.open.audit = SafeKeeping::AuditOptions{};
+    auto created = SafeKeeping::createNew("audited", options);
+    ASSERT_NE(created.instance, nullptr);
+    auto& safe = *created.instance;
+
+    ASSERT_TRUE(safe.storeSecret("audit-visible-name", "1"));
+    EXPECT_EQ(safe.retrieveSecret("audit-visible-name"), std::optional<std::string>("1"));
+    EXPECT_FALSE(safe.tryRetrieveSecret("missing").has_value());
+    EXPECT_TRUE(safe.removeSecret("audit-visible-name"));
+
+    const auto events = safe.readAuditLog();
+    ASSERT_TRUE(events.has_value());
+    ASSERT_EQ(events->size(), 4U);
+    EXPECT_EQ((*events)[0].operation, Operation::Store);
+    EXPECT_EQ((*events)[0].name, "audit-visible-name");
+    EXPECT_EQ((*events)[1].operation, Operation::Retrieve);
+    EXPECT_EQ((*events)[1].outcome, SafeKeeping::Error::None);
+    EXPECT_EQ((*events)[2].name, "missing");
+    EXPECT_EQ((*events)[2].outcome, SafeKeeping::Error::NotFound);
+    EXPECT_EQ((*events)[3].operation, Operation::Remove);
+    EXPECT_LE((*events)[0].time, (*events)[3].time);
+
+    const auto stats = safe.auditStats();
+    EXPECT_EQ(stats.recorded, 4U);
+    EXPECT_EQ(stats.written, 4U);
+    EXPECT_EQ(stats.dropped, 0U);
+
+    // Records are encrypted on disk.
+    std::ifstream file(root_ / "audited" / "audit.log", std::ios::binary);
+    const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_FALSE(contents.empty());
+    EXPECT_EQ(contents.find("audit-visible-name"), std::string::npos);
+
+    // Without the key nothing can be written, so a full buffer drops records.
+    created.instance.reset();
+    SafeKeeping::UnlockOptions unlock;
+    unlock.trySystemVaultFirst = false;
+    unlock.open.audit = SafeKeeping::AuditOptions{};
+    unlock.open.audit->capacity = 2;
+    unlock.open.audit->overflow = SafeKeeping::AuditOverflow::Block;
+    auto reopened = SafeKeeping::open("audited", unlock);
+    ASSERT_NE(reopened, nullptr);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_FALSE(reopened->tryRetrieveSecret("locked").has_value());
+    }
+    EXPECT_EQ(reopened->auditStats().recorded, 4U);
+    EXPECT_EQ(reopened->auditStats().dropped, 2U);
+    ASSERT_TRUE(reopened->unlockWithPassphrase("pw"));
+    const auto afterUnlock = reopened->readAuditLog();
+    ASSERT_TRUE(afterUnlock.has_value());
+    // The four earlier events, two locked retrieves and the unlock.
+    EXPECT_EQ(afterUnlock->size(), 7U);
+    EXPECT_EQ(afterUnlock->back().operation, Operation::UnlockPassphrase);
+}
+
+TEST_F(SafeKeepingRebootTest, AuditLogRecoversFromTornFrame) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    options.open.audit = SafeKeeping::AuditOptions{};
+    auto created = SafeKeeping::createNew("audit_torn", options);
+    ASSERT_NE(created.instance, nullptr);
+    ASSERT_TRUE(created.instance->storeSecret("first", "1"));
+    ASSERT_TRUE(created.instance->storeSecret("second", "2"));
+    created.instance.reset();
+
+    // Cut the last frame in half, as a crash during the append would.
+    const auto logPath = root_ / "audit_torn" / "audit.log";
+    const auto size = fs::file_size(logPath);
+    ASSERT_EQ(size % 2, 0U);
+    fs::resize_file(logPath, size - size / 4);
+
+    SafeKeeping::UnlockOptions unlock;
+    unlock.trySystemVaultFirst = false;
+    unlock.passphrase = std::string("pw");
+    unlock.open.audit = SafeKeeping::AuditOptions{};
+    auto reopened = SafeKeeping::open("audit_torn", unlock);
+    ASSERT_NE(reopened, nullptr);
+    ASSERT_TRUE(reopened->storeSecret("third", "3"));
+
+    const auto events = reopened->readAuditLog();
+    ASSERT_TRUE(events.has_value());
+    ASSERT_EQ(events->size(), 3U);
+    EXPECT_EQ((*events)[0].name, "first");
+    EXPECT_EQ((*events)[1].operation, SafeKeeping::Operation::UnlockPassphrase);
+    EXPECT_EQ((*events)[2].name, "third");
+}
+
+TEST_F(SafeKeepingRebootTest, SharedStoreKeepsNamespacesApart) {
+    SafeKeeping::setStoreLayout(SafeKeeping::StoreLayout::Shared);
+
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw-a");
+    auto tenantA = SafeKeeping::createNew("tenant_a", options).instance;
+    options.passphrase = std::string("pw-b");
+    auto tenantB = SafeKeeping::createNew("tenant_b", options).instance;
+    ASSERT_NE(tenantA, nullptr);
+    ASSERT_NE(tenantB, nullptr);
+
+    ASSERT_TRUE(tenantA->storeSecret("token", "value-a"));
+    ASSERT_TRUE(tenantB->storeSecret("token", "value-b"));
+    ASSERT_TRUE(tenantB->storeSecret("other", "b-only"));
+    EXPECT_EQ(tenantA->listSecrets().size(), 1U);
+    EXPECT_EQ(tenantB->listSecrets().size(), 2U);
+    EXPECT_FALSE(tenantA->tryRetrieveSecret("other").has_value());
+
+    // One database file, no per-namespace directories.
+    EXPECT_TRUE(fs::exists(root_ / "shared-vault.db"));
+    EXPECT_FALSE(fs::exists(root_ / "tenant_a"));
+    EXPECT_TRUE(SafeKeeping::exists("tenant_a"));
+    EXPECT_THROW(SafeKeeping::createNew("tenant_a", options), std::exception);
+
+    tenantA.reset();
+    auto reopened = SafeKeeping::open("tenant_a");
+    ASSERT_NE(reopened, nullptr);
+    EXPECT_FALSE(reopened->unlockWithPassphrase("pw-b"));
+    ASSERT_TRUE(reopened->unlockWithPassphrase("pw-a"));
+    EXPECT_EQ(reopened->retrieveSecret("token"), std::optional<std::string>("value-a"));
+    reopened.reset();
+
+    // The other layout does not see it, and will not reuse the name.
+    SafeKeeping::setStoreLayout(SafeKeeping::StoreLayout::PerNamespace);
+    EXPECT_FALSE(SafeKeeping::exists("tenant_a"));
+    EXPECT_EQ(SafeKeeping::open("tenant_a"), nullptr);
+    EXPECT_THROW(SafeKeeping::createNew("tenant_a", options), std::exception);
+
+    SafeKeeping::setStoreLayout(SafeKeeping::StoreLayout::Shared);
+    EXPECT_TRUE(SafeKeeping::removeNamespace("tenant_a"));
+    EXPECT_FALSE(SafeKeeping::exists("tenant_a"));
+    EXPECT_EQ(SafeKeeping::open("tenant_a"), nullptr);
+    EXPECT_EQ(tenantB->retrieveSecret("token"), std::optional<std::string>("value-b"));
+    EXPECT_EQ(tenantB->listSecrets().size(), 2U);
+}
+
+TEST_F(SafeKeepingRebootTest, SharedStoreHandleOfRemovedNamespaceFindsNothing) {
+    SafeKeeping::setStoreLayout(SafeKeeping::StoreLayout::Shared);
+
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto removed = SafeKeeping::createNew("tenant_removed", options).instance;
+    ASSERT_NE(removed, nullptr);
+    ASSERT_TRUE(removed->storeSecret("token", "old"));
+
+    // The newest namespace's id is the one a plain rowid would hand out again.
+    ASSERT_TRUE(SafeKeeping::removeNamespace("tenant_removed"));
+    auto next = SafeKeeping::createNew("tenant_next", options).instance;
+    ASSERT_NE(next, nullptr);
+    ASSERT_TRUE(next->storeSecret("token", "new"));
+
+    ASSERT_TRUE(removed->isUnlocked());
+    EXPECT_FALSE(removed->retrieveSecret("token").has_value());
+    EXPECT_EQ(removed->latestError().error, SafeKeeping::Error::NotFound);
+    EXPECT_TRUE(removed->listSecrets().empty());
+    EXPECT_EQ(removed->latestError().error, SafeKeeping::Error::NotFound);
+    EXPECT_FALSE(removed->storeSecret("token", "stale"));
+    EXPECT_EQ(removed->latestError().error, SafeKeeping::Error::NotFound);
+    EXPECT_FALSE(removed->removeSecret("token"));
+    EXPECT_EQ(removed->latestError().error, SafeKeeping::Error::NotFound);
+
+    EXPECT_EQ(next->retrieveSecret("token"), std::optional<std::string>("new"));
+    EXPECT_EQ(next->listSecrets().size(), 1U);
+}
+
+TEST_F(SafeKeepingRebootTest, ManagerClosesIdleDatabasesAndReopensThem) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    for (const auto* name : {"managed_0", "managed_1", "managed_2"}) {
+        ASSERT_NE(SafeKeeping::createNew(name, options).instance, nullptr);
+    }
+    SafeKeeping::UnlockOptions unlock;
+    unlock.trySystemVaultFirst = false;
+    unlock.passphrase = std::string("pw");
+
+    SafeKeepingManager manager(SafeKeepingManager::Options{.maxOpenDatabases = 2});
+    auto first = manager.get("managed_0", unlock);
+    ASSERT_NE(first, nullptr);
+    ASSERT_TRUE(first->storeSecret("a", "1"));
+    auto second = manager.get("managed_1", unlock);
+    ASSERT_NE(second, nullptr);
+    ASSERT_TRUE(second->storeSecret("b", "2"));
+    EXPECT_EQ(manager.get("managed_0", unlock), first);
+    EXPECT_EQ(manager.get("missing", unlock), nullptr);
+
+    // A third open namespace closes the least recently used one.
+    auto third = manager.get("managed_2", unlock);
+    ASSERT_NE(third, nullptr);
+    auto stats = manager.stats();
+    EXPECT_EQ(stats.namespaces, 3U);
+    EXPECT_EQ(stats.openDatabases, 2U);
+    EXPECT_EQ(stats.evictions, 1U);
+    if (const auto count = openDescriptorCount(namespaceDbPath(root_, "managed_0")); count >= 0) {
+        EXPECT_EQ(count, 0);
+        EXPECT_GT(openDescriptorCount(namespaceDbPath(root_, "managed_1")), 0);
+    }
+
+    // The closed handle stays usable and unlocked, and reopens lazily.
+    EXPECT_TRUE(first->isUnlocked());
+    EXPECT_EQ(first->retrieveSecret("a"), std::optional<std::string>("1"));
+    ASSERT_TRUE(first->storeSecret("a", "3"));
+    stats = manager.stats();
+    EXPECT_EQ(stats.reopens, 1U);
+    EXPECT_EQ(stats.evictions, 2U);
+    EXPECT_EQ(stats.openDatabases, 2U);
+    EXPECT_EQ(second->retrieveSecret("b"), std::optional<std::string>("2"));
+
+    EXPECT_EQ(manager.closeIdle(), 2U);
+    EXPECT_EQ(manager.stats().openDatabases, 0U);
+    EXPECT_EQ(first->retrieveSecret("a"), std::optional<std::string>("3"));
+    EXPECT_TRUE(manager.release("managed_2"));
+    EXPECT_FALSE(manager.release("managed_2"));
+    EXPECT_EQ(manager.stats().namespaces, 2U);
+
+    // Without keepUnlocked, closing also locks, and get() unlocks again.
+    first.reset();
+    second.reset();
+    third.reset();
+    SafeKeepingManager locking(SafeKeepingManager::Options{.maxOpenDatabases = 1, .keepUnlocked = false});
+    auto locked = locking.get("managed_1", unlock);
+    ASSERT_NE(locked, nullptr);
+    ASSERT_NE(locking.get("managed_2", unlock), nullptr);
+    EXPECT_FALSE(locked->isUnlocked());
+    EXPECT_EQ(locking.get("managed_1", unlock), locked);
+    EXPECT_TRUE(locked->isUnlocked());
+    EXPECT_EQ(locked->retrieveSecret("b"), std::optional<std::string>("2"));
+}
+
+TEST_F(SafeKeepingRebootTest, OpenDefersDatabaseSetupToFirstUse) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    for (const auto* name : {"lazy", "lazy_mismatch"}) {
+        auto created = SafeKeeping::createNew(name, options);
+        ASSERT_NE(created.instance, nullptr);
+        ASSERT_TRUE(created.instance->storeSecret("kept", "value"));
+    }
+    const auto dbPath = namespaceDbPath(root_, "lazy");
+    fs::permissions(dbPath, fs::perms::owner_read | fs::perms::owner_write | fs::perms::group_read);
+
+    // Opening leaves the files alone until the namespace is used.
+    SafeKeeping::UnlockOptions noUnlock;
+    noUnlock.trySystemVaultFirst = false;
+    auto reopened = SafeKeeping::open("lazy", noUnlock);
+    ASSERT_NE(reopened, nullptr);
+    if (const auto count = openDescriptorCount(dbPath); count >= 0) {
+        EXPECT_EQ(count, 0);
+    }
+    EXPECT_NE(fs::status(dbPath).permissions() & fs::perms::group_read, fs::perms::none);
+
+    ASSERT_TRUE(reopened->unlockWithPassphrase("pw"));
+    EXPECT_EQ(reopened->retrieveSecret("kept"), std::optional<std::string>("value"));
+    EXPECT_EQ(fs::status(dbPath).permissions() & fs::perms::group_read, fs::perms::none);
+    if (const auto count = openDescriptorCount(dbPath); count >= 0) {
+        EXPECT_GT(count, 0);
+    }
+
+    // A database that fails the schema check is reported by the first call.
+    execSql(namespaceDbPath(root_, "lazy_mismatch"), "UPDATE metadata SET namespace_name = 'other';");
+    auto mismatched = SafeKeeping::open("lazy_mismatch", noUnlock);
+    ASSERT_NE(mismatched, nullptr);
+    EXPECT_FALSE(mismatched->unlockWithPassphrase("pw"));
+    EXPECT_EQ(mismatched->latestError().error, SafeKeeping::Error::StorageError);
+}
+
+TEST_F(SafeKeepingRebootTest, ReadOnlyOpenRejectsWritesAndLeavesFilesAlone) {
+    SafeKeeping::CreateOptions options;
+    options.createSystemVaultSlot = false;
+    options.passphrase = std::string("pw");
+    auto created = SafeKeeping::createNew("read_only", options);
+    ASSERT_NE(created.instance, nullptr);
+    ASSERT_TRUE(created.instance->storeSecret("kept", "value"));
+    const auto dbPath = namespaceDbPath(root_, "read_only");
+    fs::permissions(dbPath, fs::perms::group_read, fs::perm_options::add);
+
+    SafeKeeping::UnlockOptions unlock;
+    unlock.trySystemVaultFirst = false;
+    unlock.passphrase = std::string("pw");
+    unlock.open.readOnly = true;
+    auto reader = SafeKeeping::open("read_only", unlock);
+    ASSERT_NE(reader, nullptr);
+    ASSERT_TRUE(reader->isUnlocked());
+    EXPECT_EQ(reader->retrieveSecret("kept"), std::optional<std::string>("value"));
+    EXPECT_EQ(reader->listSecrets().size(), 1U);
+    EXPECT_NE(fs::status(dbPath).permissions() & fs::perms::group_read, fs::perms::none);
+
+    EXPECT_FALSE(reader->storeSecret("new", "value"));
+    EXPECT_EQ(reader->latestError().error, SafeKeeping::Error::ReadOnly);
+    EXPECT_FALSE(reader->removeSecret("kept"));
+    EXPECT_EQ(reader->latestError().error, SafeKeeping::Error::ReadOnly);
+    SafeKeeping::WriteBatch batch;
+    batch.store("batched", "value");
+    EXPECT_FALSE(reader->apply(batch));
+    EXPECT_EQ(reader->latestError().error, SafeKeeping::Error::ReadOnly);
+    EXPECT_EQ(reader->openSecretWriter("streamed"), nullptr);
+    EXPECT_EQ(reader->latestError().error, SafeKeeping::Error::ReadOnly);
+    EXPECT_FALSE(reader->changePassphrase("other"));
+    EXPECT_EQ(reader->latestError().error, SafeKeeping::Error::ReadOnly);
+    EXPECT_GE(reader->stats().errorCount(SafeKeeping::Error::ReadOnly), 2U);
+
+    // Writes from a writable instance are seen by the reader.
+    ASSERT_TRUE(created.instance->storeSecret("later", "seen"));
+    EXPECT_EQ(reader->retrieveSecret("later"), std::optional<std::string>("seen"));
+    EXPECT_EQ(reader->retrieveSecret("kept"), std::optional<std::string>("value"));
+
+    SafeKeeping::CreateOptions readOnlyCreate;
+    readOnlyCreate.passphrase = std::string("pw");
+    readOnlyCreate.open.readOnly = true;
+    EXPECT_THROW(SafeKeeping::createNew("read_only_new", readOnlyCreate), std::exception);
+    unlock.open.audit = SafeKeeping::AuditOptions{};
+    EXPECT_THROW(SafeKeeping::open("read_only", unlock), std::exception);
+}
+
 TEST_F(SafeKeepingRebootTest, OpenOrCreateCreatesThenReopensNamespace) {
     SafeKeeping::CreateOptions options;
     options.createSystemVaultSlot = false;
@@ -377,6 +1774,20 @@ TEST_F(SafeKeepingRebootTest, LinuxVaultRootNameCanBeConfigured) {
 #endif
 }
 
+TEST_F(SafeKeepingRebootTest, SystemVaultTimeoutCanBeConfigured) {
+    const auto original = SafeKeeping::systemVaultTimeout();
+    EXPECT_EQ(original, std::chrono::milliseconds{10000});
+
+    SafeKeeping::setSystemVaultTimeout(std::chrono::milliseconds{250});
+    EXPECT_EQ(SafeKeeping::systemVaultTimeout(), std::chrono::milliseconds{250});
+
+    EXPECT_THROW(SafeKeeping::setSystemVaultTimeout(std::chrono::milliseconds{0}), std::invalid_argument);
+    EXPECT_THROW(SafeKeeping::setSystemVaultTimeout(std::chrono::hours{24 * 365}), std::invalid_argument);
+    EXPECT_EQ(SafeKeeping::systemVaultTimeout(), std::chrono::milliseconds{250});
+
+    SafeKeeping::setSystemVaultTimeout(original);
+}
+
 #if defined(__linux__) || defined(__unix__)
 TEST(SafeKeepingAcceptance, RealSystemVaultEntryIsStoredWithExpectedMetadata) {
     if (!envFlagEnabled("SAFEKEEPING_ACCEPT_REAL_WALLET")) {
@@ -439,4 +1850,91 @@ TEST(SafeKeepingAcceptance, RealSystemVaultEntryIsStoredWithExpectedMetadata) {
         unsetEnvVar("SAFEKEEPING_DATA_DIR");
     }
 }
+
+// Meant for a private session bus with a stand-in Secret Service, e.g.
+// dbus-run-session -- sh -c 'echo | gnome-keyring-daemon --unlock --components=secrets; test_reboot'
+TEST(SafeKeepingAcceptance, SecretServiceRoundTripsThroughOneConnection) {
+    if (!envFlagEnabled("SAFEKEEPING_ACCEPT_SECRET_SERVICE")) {
+        GTEST_SKIP() << "SAFEKEEPING_ACCEPT_SECRET_SERVICE=1 is required";
+    }
+
+    unsetEnvVar("SAFEKEEPING_TEST_FAKE_VAULT_DIR");
+    unsetEnvVar("SAFEKEEPING_DISABLE_SYSTEM_VAULT");
+
+    const fs::path root = fs::temp_directory_path() / uniqueName("safekeeping-secret-service");
+    setEnvVar("SAFEKEEPING_DATA_DIR", root);
+    const auto originalTimeout = SafeKeeping::systemVaultTimeout();
+    SafeKeeping::setSystemVaultTimeout(std::chrono::milliseconds{5000});
+
+    const std::string namespaceName = uniqueName("secret_service");
+    SafeKeeping::CreateOptions options;
+    options.passphrase = std::string("acceptance-passphrase");
+    auto created = SafeKeeping::createNew(namespaceName, options);
+    ASSERT_NE(created.instance, nullptr);
+    ASSERT_TRUE(created.instance->hasSystemVaultSlot());
+    ASSERT_TRUE(created.instance->storeSecret("k", "v"));
+    created.instance.reset();
+    const auto connections = SafeKeeping::processStats().vaultConnections;
+    EXPECT_GE(connections, 1U);
+
+    // The bulk search finds items written with the root attribute.
+    EXPECT_EQ(SafeKeeping::prefetchVaultMaterial(std::vector<std::string>{namespaceName}), 1U);
+
+    // Every open after the first reuses the connection made by createNew().
+    for (int i = 0; i < 5; ++i) {
+        auto reopened = SafeKeeping::open(namespaceName);
+        ASSERT_NE(reopened, nullptr);
+        EXPECT_TRUE(reopened->isUnlocked()) << reopened->latestError().message;
+        EXPECT_EQ(reopened->retrieveSecret("k"), std::optional<std::string>("v"));
+    }
+    EXPECT_EQ(SafeKeeping::processStats().vaultConnections, connections);
+
+    EXPECT_TRUE(SafeKeeping::removeNamespace(namespaceName));
+    SafeKeeping::setSystemVaultTimeout(originalTimeout);
+    unsetEnvVar("SAFEKEEPING_DATA_DIR");
+    std::error_code ignored;
+    fs::remove_all(root, ignored);
+}
+
+TEST(SafeKeepingAcceptance, SecretServiceCallPastTheTimeoutFailsWithVaultError) {
+    if (!envFlagEnabled("SAFEKEEPING_ACCEPT_SECRET_SERVICE")) {
+        GTEST_SKIP() << "SAFEKEEPING_ACCEPT_SECRET_SERVICE=1 is required";
+    }
+
+    unsetEnvVar("SAFEKEEPING_TEST_FAKE_VAULT_DIR");
+    unsetEnvVar("SAFEKEEPING_DISABLE_SYSTEM_VAULT");
+
+    const fs::path root = fs::temp_directory_path() / uniqueName("safekeeping-secret-service");
+    setEnvVar("SAFEKEEPING_DATA_DIR", root);
+    const auto originalTimeout = SafeKeeping::systemVaultTimeout();
+    SafeKeeping::setSystemVaultTimeout(std::chrono::milliseconds{5000});
+
+    const std::string namespaceName = uniqueName("secret_service_timeout");
+    SafeKeeping::CreateOptions options;
+    options.passphrase = std::string("acceptance-passphrase");
+    auto created = SafeKeeping::createNew(namespaceName, options);
+    ASSERT_NE(created.instance, nullptr);
+    ASSERT_TRUE(created.instance->hasSystemVaultSlot());
+    created.instance.reset();
+
+    // The deadline timer fires before the service can answer.
+    SafeKeeping::setSystemVaultTimeout(std::chrono::milliseconds{1});
+    auto safe = SafeKeeping::open(namespaceName);
+    ASSERT_NE(safe, nullptr);
+    EXPECT_FALSE(safe->isUnlocked());
+    EXPECT_EQ(safe->latestError().error, SafeKeeping::Error::VaultError);
+    EXPECT_NE(safe->latestError().message.find("did not respond within 1 ms"), std::string::npos)
+        << safe->latestError().message;
+
+    // The connection is still usable with a realistic deadline.
+    SafeKeeping::setSystemVaultTimeout(std::chrono::milliseconds{5000});
+    EXPECT_TRUE(safe->unlockWithSystemVault()) << safe->latestError().message;
+    safe.reset();
+
+    EXPECT_TRUE(SafeKeeping::removeNamespace(namespaceName));
+    SafeKeeping::setSystemVaultTimeout(originalTimeout);
+    unsetEnvVar("SAFEKEEPING_DATA_DIR");
+    std::error_code ignored;
+    fs::remove_all(root, ignored);
+}
 #endif